@@ -2,15 +2,122 @@
 #define DS18B20_H_
 
 #include "stm32f1xx_hal.h"
+#include "global_def.h"
+#include "sensor.h"
 
 // Cấu hình chân GPIO (Sửa ở đây nếu đổi chân)
 #define DS18B20_PORT GPIOB
 #define DS18B20_PIN  GPIO_PIN_13
 
-void DS18B20_Init_MicroTimer(void); // Bắt buộc gọi hàm này 1 lần đầu chương trình
+// Chọn lớp truyền 1-Wire lúc build (-DDS18B20_TRANSPORT=...)
+#define DS18B20_TRANSPORT_GPIO  0   // Bit-bang bằng BSRR/IDR + DWT
+#define DS18B20_TRANSPORT_TIM   1   // TIM1_CH1N + DMA chạy nền (onewire_tim.c)
+#define DS18B20_TRANSPORT_UART  2   // USART3 half-duplex + DMA, dây DQ nối PB10 (onewire_uart.c)
+#ifndef DS18B20_TRANSPORT
+#define DS18B20_TRANSPORT       DS18B20_TRANSPORT_GPIO
+#endif
+
+// Thời gian slot của lớp GPIO (us) và giới hạn trong datasheet DS18B20.
+// Lớp TIM/UART có bộ hằng số riêng trong onewire_tim.h / onewire_uart.h.
+#define DS18B20_T_RSTL_US       480 // Reset low: >= 480
+#define DS18B20_T_PRESENCE_US   70  // Nhả bus -> lấy mẫu presence: phải trong 60..75 (t_PDHIGH max .. t_PDHIGH min + t_PDLOW min)
+#define DS18B20_T_RSTH_US       410 // Phần còn lại của reset high: PRESENCE + RSTH >= 480
+#define DS18B20_T_LOW1_US       1   // Write-1 low: 1..15
+#define DS18B20_T_LOW0_US       60  // Write-0 low: 60..120
+#define DS18B20_T_SLOT_US       61  // Cả slot (low + high): 60..120
+#define DS18B20_T_REC_US        1   // Recovery giữa hai slot: >= 1
+#define DS18B20_T_RDLOW_US      2   // Read slot low: >= 1
+#define DS18B20_T_RDV_US        8   // Nhả bus -> lấy mẫu: RDLOW + RDV < t_RDV 15
+#define DS18B20_T_RDREST_US     50  // Phần còn lại của read slot
+
+// Host build (mô phỏng dạng sóng): -DDS18B20_PHY_EXTERNAL, khi đó kéo/nhả/
+// đọc chân và delay do chương trình mô phỏng cung cấp thay cho BSRR/IDR và
+// DWT->CYCCNT, để ghi lại dạng sóng có mốc thời gian.
+#ifdef DS18B20_PHY_EXTERNAL
+void DS18B20_PhyLow(void);
+void DS18B20_PhyRelease(void);
+uint8_t DS18B20_PhySample(void);
+void DS18B20_PhyDelayUs(uint32_t us);
+#endif
+
+#define DS18B20_SCRATCHPAD_SIZE 9   // 8 byte dữ liệu + 1 byte CRC
+#define DS18B20_READ_RETRIES    3   // Số lần đọc lại khi sai CRC
+
+// Đo chu kỳ CRC8 bitwise vs bảng nibble bằng DWT (DS18B20_CRC8_Bench), mặc định tắt
+#ifndef DS18B20_CRC_BENCH
+#define DS18B20_CRC_BENCH       0
+#endif
+#define DS18B20_CRC_BENCH_RUNS  64
+
+// Theo dõi tình trạng cảm biến
+#define DS18B20_MAX_SENSORS     4       // Số cảm biến tối đa trên bus
+#define DS18B20_STUCK_LIMIT     64      // Số lần đọc liên tiếp scratchpad giống hệt (cả 9 byte) -> kiểm tra Convert T
+#define DS18B20_RAW_POWER_ON    0x0550  // 85 °C: giá trị scratchpad sau khi cấp nguồn
+#define DS18B20_POWER_ON_WINDOW (2 * 16) // 85 °C chỉ hợp lệ nếu lần trước đã trong 2 °C
+#define DS18B20_CAL_GAIN_ONE    0x4000  // Gain hiệu chuẩn 1.0 (Q2.14)
+#define DS18B20_CAL_MAX_OFFSET  (5 * TEMP_ONE)  // Offset hiệu chuẩn tối đa ±5 °C (Q8.8)
+
+// Alarm Search: TL/TH = setpoint -/+ DS18B20_ALARM_MARGIN, cảm biến trong dải
+// không trả lời lệnh 0xEC nên chỉ được đọc 1 lần mỗi DS18B20_QUIET_PERIOD chu kỳ
+#define DS18B20_ALARM_MARGIN    2       // °C
+#define DS18B20_QUIET_PERIOD    8       // Chu kỳ đo
+
+// Giao diện sensor.h
+#define DS18B20_RESCAN_PERIOD   10      // Dò lại bus mỗi 10 chu kỳ khi có cảm biến vắng mặt
+#define DS18B20_CONV_TIMEOUT_MS 1000    // 12-bit: tối đa 750 ms
+
+// Parasite power: không poll được read slot, giữ strong pull-up đủ thời gian chuyển đổi
+#define DS18B20_CONV_TIME_MS    750     // 12-bit, datasheet t_CONV max
+
+typedef enum {
+    DS18B20_STATUS_ABSENT = 0,      // Không trả lời Match ROM / chưa đọc được lần nào
+    DS18B20_STATUS_OK,              // Giá trị hợp lệ
+    DS18B20_STATUS_CRC_ERROR,       // Có mặt nhưng scratchpad sai CRC sau khi retry
+    DS18B20_STATUS_STUCK,           // Bus kẹt mức 0, hoặc cảm biến không còn chuyển đổi (Convert T không làm bus bận)
+    DS18B20_STATUS_POWER_ON_RESET   // Đọc được 85 °C của lúc cấp nguồn
+} DS18B20_Status_t;
+
+typedef struct {
+    uint8_t rom[8];                 // 64-bit ROM code
+    DS18B20_Status_t status;
+    uint8_t crcErrors;              // Số lần sai CRC liên tiếp
+    uint8_t stuckCount;             // Số lần đọc liên tiếp scratchpad giống hệt
+    uint8_t lastScratchpad[DS18B20_SCRATCHPAD_SIZE]; // Scratchpad hợp lệ gần nhất (cả 9 byte)
+    int16_t lastRaw;                // Raw Q4 hợp lệ gần nhất
+    Temp_t temp;                    // Nhiệt độ hợp lệ gần nhất (Q8.8), đã hiệu chuẩn
+    int16_t calOffset;              // Hiệu chuẩn: offset Q8.8 (mặc định 0)
+    int16_t calGain;                // Hiệu chuẩn: gain Q2.14 (mặc định DS18B20_CAL_GAIN_ONE)
+    int8_t alarmHigh;               // TH đang nằm trong scratchpad của cảm biến
+    int8_t alarmLow;                // TL đang nằm trong scratchpad của cảm biến
+    uint8_t quietCycles;            // Số chu kỳ liên tiếp không đọc (trong dải)
+} DS18B20_Sensor_t;
+
+void DS18B20_Init(void);            // Bắt buộc gọi hàm này 1 lần đầu chương trình (timer + lớp truyền 1-Wire)
+void DS18B20_Init_MicroTimer(void);
 uint8_t DS18B20_Start(void);
 void DS18B20_Write(uint8_t data);
 uint8_t DS18B20_Read(void);
-float DS18B20_GetTemp(void);
+uint8_t DS18B20_CRC8(const uint8_t *data, uint8_t length);
+#if DS18B20_CRC_BENCH
+uint8_t DS18B20_CRC8_Bench(uint32_t *bitwiseCycles, uint32_t *tableCycles);
+#endif
+uint8_t DS18B20_Select(const uint8_t *rom);
+HAL_StatusTypeDef DS18B20_ReadScratchpad(const uint8_t *rom, uint8_t *scratchpad);
+uint8_t DS18B20_IsParasite(const uint8_t *rom);
+uint8_t DS18B20_IsBusLocked(void);
+uint32_t DS18B20_GetIrqMaskMaxCycles(void);     // Đoạn chặn ngắt dài nhất (chu kỳ CPU)
+void DS18B20_ResetIrqMaskStats(void);
+uint8_t DS18B20_SearchRom(uint8_t roms[][8], uint8_t maxCount);
+uint8_t DS18B20_AlarmSearch(uint8_t roms[][8], uint8_t maxCount);
+HAL_StatusTypeDef DS18B20_SetAlarm(DS18B20_Sensor_t *sensor, int8_t low, int8_t high);
+uint8_t DS18B20_Enumerate(DS18B20_Sensor_t *sensors, uint8_t count, uint8_t maxCount);
+HAL_StatusTypeDef DS18B20_ReadSensor(DS18B20_Sensor_t *sensor);
+void DS18B20_ReadFleet(DS18B20_Sensor_t *sensors, uint8_t count, int8_t low, int8_t high, uint8_t mustRead);
+HAL_StatusTypeDef DS18B20_GetTemp(Temp_t *pTemp);
+
+// Cả bus DS18B20 là một Sensor_t (ctx = NULL): nhiệt độ là của cảm biến khỏe đầu tiên
+extern const SensorOps_t DS18B20_SensorOps;
+void DS18B20_SetAlarmBand(int8_t low, int8_t high);
+HAL_StatusTypeDef DS18B20_CalibratePrimary(Temp_t reference);  // Offset để cảm biến chính đọc đúng reference, lưu vào flash
 
 #endif /* DS18B20_H_ */
@@ -7,8 +7,8 @@
 /* ========== Task Function Prototypes ========== */
 
 /**
- * @brief Task_Sensor - Read temperature from DS18B20
- * Period: 500ms
+ * @brief Task_Sensor - Start/poll/read every configured sensor (non-blocking)
+ * Period: 10ms poll, 500ms per sensor conversion
  * Priority: Normal
  */
 void Task_Sensor(void);
@@ -34,6 +34,10 @@ void Task_Control(void);
  */
 void Task_Display(void);
 
+/* ========== Display Statistics ========== */
+uint16_t Task_Display_GetWireBytes(void);  // I2C bytes of the last frame
+uint32_t Task_Display_GetFmtCycles(void);  // DWT cycles in FixFmt_* for the last frame
+
 /* ========== Task Scheduler ========== */
 void Task_Scheduler_Init(void);
 void Task_Scheduler_Run(void);
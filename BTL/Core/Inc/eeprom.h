@@ -16,12 +16,25 @@
 /* We use the last page (Page 63) starting at 0x0800FC00 for EEPROM */
 #define EEPROM_START_ADDR    0x0800FC00UL    /* Last page (63) of flash */
 #define EEPROM_PAGE_SIZE     512             /* Page size in bytes */
+#define EEPROM_VERSION       2               /* Layout version (1 = setpoint only) */
+#define EEPROM_MAX_CALIB     8               /* Calibration entries (one per sensor) */
+#define EEPROM_CALIB_GAIN_ONE 0x4000         /* Gain 1.0 in Q2.14 */
+
+/* Per-sensor two-point calibration, keyed by 64-bit ROM code.
+   corrected = raw * gain / 2^14 + offset (Q8.8 degC, integer math) */
+typedef struct {
+    uint8_t rom[8];         /* DS18B20 ROM code, all 0xFF = free entry */
+    int16_t offset;         /* Offset in Q8.8 degC */
+    int16_t gain;           /* Gain in Q2.14 (0x4000 = 1.0) */
+} EEPROMCalib_t;
 
 /* EEPROM data structure - stored in last flash page */
 typedef struct {
     uint32_t magic;         /* Magic number 0xDEADBEEF for validation */
     int8_t setTemp;         /* Stored setpoint (10-50°C) */
-    uint16_t crc;           /* CRC16 checksum for data integrity */
+    uint8_t version;        /* EEPROM_VERSION */
+    EEPROMCalib_t calib[EEPROM_MAX_CALIB];  /* Sensor calibration table */
+    uint16_t crc;           /* CRC16 checksum for data integrity (last member) */
 } EEPROMData_t;
 
 /* ========== Function Prototypes ========== */
@@ -53,6 +66,24 @@ HAL_StatusTypeDef EEPROM_LoadSetpoint(int8_t *pSetTemp);
  */
 HAL_StatusTypeDef EEPROM_Erase(int8_t defaultSetTemp);
 
+/**
+ * @brief Look up calibration coefficients for a sensor
+ * @param rom: 64-bit ROM code of the sensor
+ * @param pOffset: Pointer to store offset (Q8.8 degC)
+ * @param pGain: Pointer to store gain (Q2.14)
+ * @retval HAL_OK if an entry exists, HAL_ERROR otherwise (outputs = identity)
+ */
+HAL_StatusTypeDef EEPROM_LoadCalibration(const uint8_t *rom, int16_t *pOffset, int16_t *pGain);
+
+/**
+ * @brief Store calibration coefficients for a sensor (replaces existing entry)
+ * @param rom: 64-bit ROM code of the sensor
+ * @param offset: Offset in Q8.8 degC
+ * @param gain: Gain in Q2.14
+ * @retval HAL_OK if successful, HAL_ERROR if the table is full or flash fails
+ */
+HAL_StatusTypeDef EEPROM_SaveCalibration(const uint8_t *rom, int16_t offset, int16_t gain);
+
 /**
  * @brief Calculate CRC16 checksum
  * @param data: Pointer to data
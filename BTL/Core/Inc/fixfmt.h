@@ -0,0 +1,52 @@
+/**
+  ******************************************************************************
+  * @file    fixfmt.h
+  * @brief   Fixed-point to decimal formatting without printf
+  * @details Converts Qm.n integers to right-aligned, fixed-width decimal
+  *          text using only integer math, so the display and telemetry
+  *          paths need neither newlib's printf nor the soft-float library.
+  *          Every function writes its text at dst, NUL-terminates it and
+  *          returns a pointer to the terminator so calls can be chained.
+  ******************************************************************************
+  */
+
+#ifndef FIXFMT_H_
+#define FIXFMT_H_
+
+#include <stdint.h>
+
+/* ========== Formatter Configuration ========== */
+#define FIXFMT_MAX_DECIMALS   4     /* (2^16 - 1) * 10^4 fits in 32 bits */
+#define FIXFMT_MAX_FRAC_BITS  16
+#define FIXFMT_OVERFLOW_CHAR  '*'   /* Fills the field when the value is too wide */
+
+/* ========== Function Prototypes ========== */
+
+/**
+ * @brief Format a signed fixed-point value
+ * @param dst: Output buffer (at least max(width, 16) + 1 bytes)
+ * @param value: Fixed-point value with fracBits fractional bits
+ * @param fracBits: Fractional bits in value (0..FIXFMT_MAX_FRAC_BITS, 0 = integer)
+ * @param decimals: Digits after the point (0..FIXFMT_MAX_DECIMALS), rounded
+ *                  half away from zero
+ * @param width: Field width, right-aligned with spaces; 0 = no padding.
+ *               A value that does not fit is shown as width overflow chars.
+ * @retval Pointer to the terminating NUL
+ * @note  A result that rounds to zero is printed without a minus sign.
+ */
+char *FixFmt_Q(char *dst, int32_t value, uint8_t fracBits, uint8_t decimals, uint8_t width);
+
+/**
+ * @brief Format a signed integer, right-aligned in width (0 = no padding)
+ * @retval Pointer to the terminating NUL
+ */
+char *FixFmt_Int(char *dst, int32_t value, uint8_t width);
+
+/**
+ * @brief Copy a string, right-aligned in width (0 = no padding)
+ * @note  Used for placeholders such as "--.-" so they line up with values
+ * @retval Pointer to the terminating NUL
+ */
+char *FixFmt_Str(char *dst, const char *str, uint8_t width);
+
+#endif /* FIXFMT_H_ */
@@ -3,11 +3,23 @@
 
 #include "stm32f1xx_hal.h"
 
+/* ========== Fixed-Point Temperature ========== */
+/* Signed Q8.8: 1 LSB = 1/256 degC, range -128.00..+127.99 degC.
+   Covers the DS18B20 range (-55..+125) and keeps 4 bits below the sensor's
+   1/16 degC LSB for filtering. All math is integer: no soft-float on the M3. */
+typedef int16_t Temp_t;
+#define TEMP_FRAC_BITS      8
+#define TEMP_ONE            (1 << TEMP_FRAC_BITS)
+#define TEMP_FROM_INT(c)    ((Temp_t)((c) * TEMP_ONE))
+
 /* ========== System State Structure ========== */
 typedef struct {
-    float currentTemp;      // Current temperature from DS18B20
+    Temp_t currentTemp;     // Current temperature from DS18B20 (Q8.8 degC)
+    Temp_t trend;           // Temperature slope (Q8.8 degC/min)
     int8_t setTemp;         // Desired temperature set by user
     uint8_t isFanOn;        // Fan status (1: ON, 0: OFF)
+    uint8_t sensorOk;       // 1: currentTemp comes from a healthy sensor
+    uint8_t tempDigits;     // Decimals worth displaying (1 or 2, from sensor resolution)
     uint8_t mode;           // 0: OFF, 1: NORMAL, 2: SETTING
     uint8_t button_up;      // Button UP state (PA2)
     uint8_t button_down;    // Button DOWN state (PA3)
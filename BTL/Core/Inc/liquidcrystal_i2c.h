@@ -3,6 +3,14 @@
 
 #include "stm32f1xx_hal.h"
 
+/* Configuration */
+
+/* Poll the HD44780 busy flag through the PCF8574 instead of fixed delays.
+   Set to 0 for backpacks with RW strapped to GND (also detected once at init). */
+#ifndef LCD_BUSY_POLL
+#define LCD_BUSY_POLL 1
+#endif
+
 /* Command */
 #define LCD_CLEARDISPLAY 0x01
 #define LCD_RETURNHOME 0x02
@@ -49,7 +57,7 @@
 #define ENABLE 0x04
 
 /* Read Write Bit */
-#define RW 0x0
+#define RW 0x02
 
 /* Register Select Bit */
 #define RS 0x01
@@ -57,6 +65,37 @@
 /* Device I2C Address */
 #define DEVICE_ADDR     (0x27 << 1)
 
+/* Shadow framebuffer geometry (up to 4x20) */
+#define LCD_FB_ROWS     2
+#define LCD_FB_COLS     16
+
+/* CGRAM glyph cache: 8 slots shown as codes 8-15, which alias CGRAM 0-7,
+   so a glyph never terminates a string */
+#define LCD_GLYPH_SLOTS     8
+#define LCD_GLYPH_CODE(s)   (0x08 + (s))
+#define LCD_GLYPH_USER      0x80  /* First id for caller-generated glyphs */
+#define LCD_GLYPH_FALLBACK  '?'   /* Returned when all slots are drawn this frame */
+
+/* Packed PCF8574 stream: 3 expander bytes per nibble, 6 per LCD byte.
+   Sized for a full framebuffer flush (one cursor move + text per row)
+   plus a CGRAM upload (address + 8 rows) for every glyph slot. */
+#define LCD_TX_BUF_SIZE (6 * (LCD_FB_ROWS * (LCD_FB_COLS + 1) + LCD_GLYPH_SLOTS * 9))
+
+/* Upper bound for a DMA flush to complete (full frame is ~16 ms at 100 kHz) */
+#define LCD_TX_TIMEOUT_MS 100
+
+/* Upper bound for HAL_I2C_Master_Abort_IT() to return the bus to READY */
+#define LCD_ABORT_TIMEOUT_MS 5
+
+/* Built-in icons for lcdIcon(); ids below LCD_GLYPH_USER */
+typedef enum {
+  LCD_ICON_FAN = 0,
+  LCD_ICON_DEGREE,
+  LCD_ICON_ARROW_UP,
+  LCD_ICON_ARROW_DOWN,
+  LCD_ICON_COUNT
+} LcdIcon_t;
+
 void HD44780_Init(uint8_t rows);
 void HD44780_Clear();
 void HD44780_Home();
@@ -94,4 +133,16 @@ void lcdWriteChar(char ch);
 void lcdBacklight(void);
 void lcdNoBacklight(void);
 
+/* ========== Shadow Framebuffer ========== */
+void lcdFbClear(void);
+void lcdFbWrite(uint8_t row, uint8_t col, const char *str);
+uint16_t lcdFlush(void);
+uint16_t lcdFlushAsync(void);
+uint8_t lcdBusy(void);
+uint32_t lcdWireBytes(void);
+
+/* ========== CGRAM Glyph Cache ========== */
+char lcdGlyph(uint8_t id, const uint8_t bitmap[8]);
+char lcdIcon(LcdIcon_t icon);
+
 #endif /* LIQUIDCRYSTAL_I2C_H_ */
@@ -0,0 +1,30 @@
+/**
+  ******************************************************************************
+  * @file    lm75.h
+  * @brief   LM75 (and compatible) I2C temperature sensor driver
+  * @details The LM75 converts continuously (about 100 ms per conversion), so
+  *          start() is a no-op and ready() is always true; read() fetches
+  *          the 9-bit (0.5 degC) temperature register.
+  ******************************************************************************
+  */
+
+#ifndef LM75_H_
+#define LM75_H_
+
+#include "sensor.h"
+
+/* ========== LM75 Definitions ========== */
+#define LM75_ADDR_DEFAULT        (0x48 << 1)   /* A2..A0 = 0, HAL 8-bit address */
+#define LM75_REG_TEMP            0x00
+#define LM75_I2C_TIMEOUT         10            /* ms */
+
+/* ========== Data Types ========== */
+typedef struct {
+    I2C_HandleTypeDef *hi2c;
+    uint16_t addr;               /* HAL 8-bit address */
+    SensorHealth_t health;
+} LM75_t;
+
+extern const SensorOps_t LM75_SensorOps;
+
+#endif /* LM75_H_ */
@@ -0,0 +1,79 @@
+/**
+  ******************************************************************************
+  * @file    onewire_multi.h
+  * @brief   Parallel bit-banging of up to 16 1-Wire segments on GPIOB
+  * @details Every segment is one GPIOB pin with its own pull-up. All segments
+  *          share the slot timing: one BSRR write per slot edge drives every
+  *          pin, one IDR read samples every pin. Per-segment bytes are
+  *          converted to/from per-slot port masks by 8x8 bit transposition,
+  *          so N segments cost the same bus time as one.
+  ******************************************************************************
+  */
+
+#ifndef ONEWIRE_MULTI_H_
+#define ONEWIRE_MULTI_H_
+
+#include "stm32f1xx_hal.h"
+
+/* ========== Segment Configuration ========== */
+/* One segment per pin; segment index == pin number on GPIOB.
+   Avoid PB2 (BOOT1), PB6/PB7 (I2C1 LCD), PB12 and PB13 (DS18B20). */
+#define ONEWIRE_MULTI_PORT       GPIOB
+#define ONEWIRE_MULTI_MASK       (GPIO_PIN_0 | GPIO_PIN_1 | GPIO_PIN_8 | \
+                                  GPIO_PIN_9 | GPIO_PIN_14 | GPIO_PIN_15)
+#define ONEWIRE_MULTI_SEGMENTS   16
+
+/* Host build (waveform simulator): -DONEWIRE_MULTI_PHY_EXTERNAL replaces the
+   BSRR writes, IDR reads and DWT delay with these hooks */
+#ifdef ONEWIRE_MULTI_PHY_EXTERNAL
+void OneWire_Multi_PhyDrive(uint32_t bsrr);
+uint16_t OneWire_Multi_PhySample(void);
+void OneWire_Multi_PhyDelayUs(uint32_t us);
+#endif
+
+/* ========== Function Prototypes ========== */
+
+/**
+ * @brief Configure all segment pins as open-drain outputs, bus released
+ * @note  Uses the DWT cycle counter enabled by DS18B20_Init()
+ */
+void OneWire_Multi_Init(void);
+
+/**
+ * @brief Reset pulse on all segments at once
+ * @retval Mask of segments that answered with a presence pulse
+ */
+uint16_t OneWire_Multi_Reset(void);
+
+/**
+ * @brief Send the same byte on all segments
+ * @param data: Byte to send (LSB first)
+ */
+void OneWire_Multi_WriteByte(uint8_t data);
+
+/**
+ * @brief Send a different byte on each segment in the same 8 slots
+ * @param data: One byte per segment, indexed by pin number
+ */
+void OneWire_Multi_WriteBytes(const uint8_t data[ONEWIRE_MULTI_SEGMENTS]);
+
+/**
+ * @brief Read one byte from every segment in the same 8 slots
+ * @param data: One byte per segment, indexed by pin number
+ */
+void OneWire_Multi_ReadBytes(uint8_t data[ONEWIRE_MULTI_SEGMENTS]);
+
+/**
+ * @brief Start a temperature conversion on every segment (Skip ROM + 0x44)
+ * @retval Mask of segments with a sensor present
+ */
+uint16_t OneWire_Multi_StartConversion(void);
+
+/**
+ * @brief Read and CRC-check the scratchpad of one sensor per segment
+ * @param scratchpad: 9 bytes per segment, indexed by pin number
+ * @retval Mask of segments with a present sensor and valid CRC
+ */
+uint16_t OneWire_Multi_ReadScratchpads(uint8_t scratchpad[ONEWIRE_MULTI_SEGMENTS][9]);
+
+#endif /* ONEWIRE_MULTI_H_ */
@@ -0,0 +1,80 @@
+/**
+  ******************************************************************************
+  * @file    onewire_tim.h
+  * @brief   Background 1-Wire bit engine using TIM1 + DMA1
+  * @details The 1-Wire pin (PB13 = TIM1_CH1N) is driven by TIM1 in PWM mode.
+  *          Each timer period is one time slot; DMA reloads the pulse width
+  *          for the next slot on every update event and a second DMA channel
+  *          samples GPIOB->IDR on the CC4 event. The CPU is interrupted only
+  *          once, when the whole transaction has finished.
+  ******************************************************************************
+  */
+
+#ifndef ONEWIRE_TIM_H_
+#define ONEWIRE_TIM_H_
+
+#include "stm32f1xx_hal.h"
+
+/* ========== Engine Configuration ========== */
+#define ONEWIRE_TIM_MAX_BITS     96     /* Longest transaction: 12 bytes */
+
+/* Slot timing in microseconds (timer runs at 1 MHz) */
+#define ONEWIRE_TIM_SLOT_US      70     /* Time slot incl. recovery */
+#define ONEWIRE_TIM_WRITE0_US    60     /* Low time for write-0 */
+#define ONEWIRE_TIM_WRITE1_US    2      /* Low time for write-1 / read */
+#define ONEWIRE_TIM_SAMPLE_US    12     /* Sample point after falling edge */
+#define ONEWIRE_TIM_RESET_US     480    /* Reset pulse low time */
+#define ONEWIRE_TIM_PRESENCE_US  550    /* Presence sample point */
+#define ONEWIRE_TIM_RSTSLOT_US   960    /* Reset slot incl. presence window */
+
+/* ========== Function Prototypes ========== */
+
+/**
+ * @brief Configure TIM1, DMA1 channels 4/5 and PB13 as TIM1_CH1N open-drain
+ */
+void OneWire_Tim_Init(void);
+
+/**
+ * @brief Start a reset/presence slot in the background
+ * @retval HAL_OK if started, HAL_BUSY if a transaction is in progress
+ */
+HAL_StatusTypeDef OneWire_Tim_StartReset(void);
+
+/**
+ * @brief Start a bit transaction in the background
+ * @param tx: Bits to send, LSB first (1 also means "read slot")
+ * @param nbits: Number of time slots (1..ONEWIRE_TIM_MAX_BITS)
+ * @retval HAL_OK if started, HAL_BUSY if busy, HAL_ERROR on bad length
+ */
+HAL_StatusTypeDef OneWire_Tim_StartTransfer(const uint8_t *tx, uint16_t nbits);
+
+/**
+ * @brief Check whether a transaction is still running
+ * @retval 1 if busy, 0 if idle
+ */
+uint8_t OneWire_Tim_IsBusy(void);
+
+/**
+ * @brief Copy sampled bits of the last transaction (LSB first)
+ * @param rx: Destination, (nbits + 7) / 8 bytes
+ * @param nbits: Number of bits to copy
+ */
+void OneWire_Tim_GetResult(uint8_t *rx, uint16_t nbits);
+
+/**
+ * @brief Result of the last reset slot
+ * @retval 1 if a presence pulse was detected, 0 otherwise
+ */
+uint8_t OneWire_Tim_Presence(void);
+
+/**
+ * @brief Blocking wrappers: start, sleep until done, return result
+ */
+uint8_t OneWire_Tim_Reset(void);
+void OneWire_Tim_Transfer(const uint8_t *tx, uint8_t *rx, uint16_t nbits);
+
+/* ========== Interrupt Handlers (called from stm32f1xx_it.c) ========== */
+void OneWire_Tim_DMA_IRQHandler(void);
+void OneWire_Tim_UP_IRQHandler(void);
+
+#endif /* ONEWIRE_TIM_H_ */
@@ -0,0 +1,77 @@
+/**
+  ******************************************************************************
+  * @file    onewire_uart.h
+  * @brief   1-Wire transport over USART3 in single-wire half-duplex mode
+  * @details Every 1-Wire time slot is one UART frame. Reset/presence is a
+  *          0xF0 frame at 9600 baud, bit slots are 0xFF (write-1 / read) or
+  *          0x00 (write-0) frames at 115200 baud. TX and RX both run on DMA,
+  *          so a whole transaction is one pair of DMA transfers.
+  ******************************************************************************
+  */
+
+#ifndef ONEWIRE_UART_H_
+#define ONEWIRE_UART_H_
+
+#include "stm32f1xx_hal.h"
+
+/* ========== Transport Configuration ========== */
+/* USART3_TX in half-duplex mode; the sensor data line moves to this pin */
+#define ONEWIRE_UART_PORT        GPIOB
+#define ONEWIRE_UART_PIN         GPIO_PIN_10
+
+#define ONEWIRE_UART_MAX_BITS    96      /* Longest transaction: 12 bytes */
+
+#define ONEWIRE_UART_RESET_BAUD  9600
+#define ONEWIRE_UART_DATA_BAUD   115200
+#define ONEWIRE_UART_RESET_BYTE  0xF0    /* 520us low, presence pulls upper bits */
+
+/* ========== Function Prototypes ========== */
+
+/**
+ * @brief Configure USART3 half-duplex, DMA1 channels 2/3 and PB10 open-drain
+ */
+void OneWire_Uart_Init(void);
+
+/**
+ * @brief Start a reset/presence frame in the background
+ * @retval HAL_OK if started, HAL_BUSY if a transaction is in progress
+ */
+HAL_StatusTypeDef OneWire_Uart_StartReset(void);
+
+/**
+ * @brief Start a bit transaction in the background
+ * @param tx: Bits to send, LSB first (1 also means "read slot")
+ * @param nbits: Number of time slots (1..ONEWIRE_UART_MAX_BITS)
+ * @retval HAL_OK if started, HAL_BUSY if busy, HAL_ERROR on bad length
+ */
+HAL_StatusTypeDef OneWire_Uart_StartTransfer(const uint8_t *tx, uint16_t nbits);
+
+/**
+ * @brief Check whether a transaction is still running
+ * @retval 1 if busy, 0 if idle
+ */
+uint8_t OneWire_Uart_IsBusy(void);
+
+/**
+ * @brief Copy sampled bits of the last transaction (LSB first)
+ * @param rx: Destination, (nbits + 7) / 8 bytes
+ * @param nbits: Number of bits to copy
+ */
+void OneWire_Uart_GetResult(uint8_t *rx, uint16_t nbits);
+
+/**
+ * @brief Result of the last reset frame
+ * @retval 1 if a presence pulse was detected, 0 otherwise
+ */
+uint8_t OneWire_Uart_Presence(void);
+
+/**
+ * @brief Blocking wrappers: start, sleep until done, return result
+ */
+uint8_t OneWire_Uart_Reset(void);
+void OneWire_Uart_Transfer(const uint8_t *tx, uint8_t *rx, uint16_t nbits);
+
+/* ========== Interrupt Handler (called from stm32f1xx_it.c) ========== */
+void OneWire_Uart_DMA_IRQHandler(void);
+
+#endif /* ONEWIRE_UART_H_ */
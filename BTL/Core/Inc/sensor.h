@@ -0,0 +1,107 @@
+/**
+  ******************************************************************************
+  * @file    sensor.h
+  * @brief   Pluggable temperature sensor interface
+  * @details A sensor is a set of operations (start, poll-ready, read, health)
+  *          plus a driver context. Sensor_Poll() runs the non-blocking
+  *          start -> poll -> read cycle so Task_Sensor never waits for a
+  *          conversion: DS18B20 (up to 750 ms) and I2C sensors (10-20 ms)
+  *          are scheduled side by side from the same table.
+  *          Optional oversampling averages 2^shift consecutive readings
+  *          into one output for extra fractional resolution.
+  ******************************************************************************
+  */
+
+#ifndef SENSOR_H_
+#define SENSOR_H_
+
+#include "stm32f1xx_hal.h"
+#include "global_def.h"
+
+/* ========== Sensor Configuration ========== */
+/* Optional I2C sensors on hi2c1 (shared with the LCD), 0 = not fitted */
+#ifndef SENSOR_USE_LM75
+#define SENSOR_USE_LM75          0
+#endif
+#ifndef SENSOR_USE_SHT3X
+#define SENSOR_USE_SHT3X         0
+#endif
+
+/* Oversampling: average 2^shift readings per output (each 4x adds one bit) */
+#define SENSOR_OVERSAMPLE_MAX_SHIFT  6   /* K <= 64, accumulator stays in int32 */
+
+/* ========== Data Types ========== */
+typedef enum {
+    SENSOR_HEALTH_OK = 0,        /* Last read returned a usable value */
+    SENSOR_HEALTH_ABSENT,        /* Device does not answer */
+    SENSOR_HEALTH_ERROR          /* Device answers but data is not usable */
+} SensorHealth_t;
+
+typedef enum {
+    SENSOR_STATE_IDLE = 0,       /* Waiting for the next period */
+    SENSOR_STATE_CONVERTING      /* Conversion started, polling ready */
+} SensorState_t;
+
+typedef struct Sensor_s Sensor_t;
+
+/* Driver operations; ctx is the driver's own state */
+typedef struct {
+    const char *name;
+    uint8_t fracBits;                                      /* Native resolution: LSB = 2^-fracBits degC */
+    HAL_StatusTypeDef (*start)(void *ctx);                 /* Start a conversion */
+    uint8_t (*ready)(void *ctx);                           /* 1 when the conversion is done */
+    HAL_StatusTypeDef (*read)(void *ctx, Temp_t *pTemp);   /* Fetch result (Q8.8 degC) */
+    SensorHealth_t (*health)(void *ctx);                   /* Health after the last read */
+} SensorOps_t;
+
+/* One configured sensor and its scheduling state */
+struct Sensor_s {
+    const SensorOps_t *ops;
+    void *ctx;
+    uint16_t periodMs;           /* Time between conversion starts */
+    uint16_t timeoutMs;          /* Give up on a conversion after this long */
+    uint8_t oversampleShift;     /* Average 2^shift readings per output, 0 = off */
+    SensorState_t state;
+    uint32_t startTick;          /* HAL_GetTick() of the last start */
+    Temp_t temp;                 /* Last valid reading (Q8.8 degC) */
+    uint8_t valid;               /* 1 if temp comes from the last completed cycle */
+    int32_t acc;                 /* Sum of readings since the last output */
+    uint8_t accCount;            /* Readings in acc */
+};
+
+/* Table initializer: first conversion starts on the first Sensor_Poll() */
+#define SENSOR_ENTRY(ops_, ctx_, period_, timeout_, shift_) \
+    { (ops_), (ctx_), (period_), (timeout_), (shift_), SENSOR_STATE_IDLE, 0, 0, 0, 0, 0 }
+
+/* ========== Function Prototypes ========== */
+
+/**
+ * @brief Reset scheduling state so the next poll starts a conversion
+ * @param sensor: Sensor instance
+ * @param now: Current HAL_GetTick()
+ */
+void Sensor_Init(Sensor_t *sensor, uint32_t now);
+
+/**
+ * @brief Advance the start/poll/read cycle of one sensor (never blocks)
+ * @param sensor: Sensor instance
+ * @param now: Current HAL_GetTick()
+ * @retval 1 if a new valid reading was stored in sensor->temp, 0 otherwise
+ */
+uint8_t Sensor_Poll(Sensor_t *sensor, uint32_t now);
+
+/**
+ * @brief Health as reported by the driver
+ * @param sensor: Sensor instance
+ * @retval SensorHealth_t
+ */
+SensorHealth_t Sensor_Health(const Sensor_t *sensor);
+
+/**
+ * @brief Effective resolution of sensor->temp after oversampling
+ * @param sensor: Sensor instance
+ * @retval Fractional bits that carry information (<= TEMP_FRAC_BITS)
+ */
+uint8_t Sensor_ResolutionBits(const Sensor_t *sensor);
+
+#endif /* SENSOR_H_ */
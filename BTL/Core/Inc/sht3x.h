@@ -0,0 +1,33 @@
+/**
+  ******************************************************************************
+  * @file    sht3x.h
+  * @brief   SHT3x (SHT30/31/35) I2C temperature/humidity sensor driver
+  * @details Single-shot, high repeatability, no clock stretching: start()
+  *          sends the measure command, ready() waits out the 15 ms
+  *          conversion time, read() fetches and CRC-checks both words.
+  ******************************************************************************
+  */
+
+#ifndef SHT3X_H_
+#define SHT3X_H_
+
+#include "sensor.h"
+
+/* ========== SHT3x Definitions ========== */
+#define SHT3X_ADDR_DEFAULT       (0x44 << 1)   /* ADDR pin low, HAL 8-bit address */
+#define SHT3X_CMD_MEASURE_HIGH   0x2400        /* Single shot, high repeatability, no stretch */
+#define SHT3X_CONVERSION_MS      16            /* Datasheet max 15.5 ms */
+#define SHT3X_I2C_TIMEOUT        10            /* ms */
+
+/* ========== Data Types ========== */
+typedef struct {
+    I2C_HandleTypeDef *hi2c;
+    uint16_t addr;               /* HAL 8-bit address */
+    uint32_t startTick;          /* HAL_GetTick() of the measure command */
+    uint16_t humidity;           /* Last relative humidity, Q8.8 %RH */
+    SensorHealth_t health;
+} SHT3x_t;
+
+extern const SensorOps_t SHT3x_SensorOps;
+
+#endif /* SHT3X_H_ */
@@ -0,0 +1,52 @@
+/**
+  ******************************************************************************
+  * @file    temp_filter.h
+  * @brief   Sensor sample filter: median-of-N spike rejection + integer EMA
+  * @details Sits between the sensor driver and thermostat_state. Runs in
+  *          constant time per sample (fixed N, no loops on history length)
+  *          and uses integer math only.
+  ******************************************************************************
+  */
+
+#ifndef TEMP_FILTER_H_
+#define TEMP_FILTER_H_
+
+#include <stdint.h>
+#include "global_def.h"
+
+/* ========== Filter Configuration ========== */
+#define TEMP_FILTER_MEDIAN_N     3    /* Odd window length, 1 disables the median */
+#define TEMP_FILTER_EMA_SHIFT    2    /* EMA weight = 1 / 2^shift, 0 disables the EMA */
+
+/* ========== Data Types ========== */
+/* One temperature sample with its acquisition time */
+typedef struct {
+    Temp_t value;           /* Q8.8 degC */
+    uint32_t timestamp;     /* HAL_GetTick() at acquisition (ms) */
+} TempSample_t;
+
+/* Filter state, one instance per sensor */
+typedef struct {
+    Temp_t window[TEMP_FILTER_MEDIAN_N];   /* Ring of the last N raw samples */
+    uint8_t head;                          /* Next slot to overwrite */
+    uint8_t primed;                        /* 0 until the first sample */
+    int32_t ema;                           /* EMA, Q8.8 << TEMP_FILTER_EMA_SHIFT */
+} TempFilter_t;
+
+/* ========== Function Prototypes ========== */
+
+/**
+ * @brief Reset the filter; the next sample primes the window and the EMA
+ * @param filter: Filter instance
+ */
+void TempFilter_Init(TempFilter_t *filter);
+
+/**
+ * @brief Push one raw sample and get the filtered one
+ * @param filter: Filter instance
+ * @param sample: Raw sample from the driver
+ * @retval Filtered sample (same timestamp as the input)
+ */
+TempSample_t TempFilter_Update(TempFilter_t *filter, TempSample_t sample);
+
+#endif /* TEMP_FILTER_H_ */
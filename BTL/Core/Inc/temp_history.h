@@ -0,0 +1,56 @@
+/**
+  ******************************************************************************
+  * @file    temp_history.h
+  * @brief   Downsampled temperature history for the display sparkline
+  * @details Filtered samples are averaged over TEMP_HISTORY_PERIOD_MS and
+  *          each mean is pushed into a TEMP_HISTORY_LEN ring, so the ring
+  *          spans LEN * PERIOD of history in a few dozen bytes of RAM.
+  ******************************************************************************
+  */
+
+#ifndef TEMP_HISTORY_H_
+#define TEMP_HISTORY_H_
+
+#include <stdint.h>
+#include "global_def.h"
+#include "temp_filter.h"
+
+/* ========== History Configuration ========== */
+#define TEMP_HISTORY_LEN         16      /* One sparkline column per entry */
+#define TEMP_HISTORY_PERIOD_MS   30000   /* 16 x 30 s = 8 minutes on screen */
+
+/* ========== Data Types ========== */
+typedef struct {
+    Temp_t ring[TEMP_HISTORY_LEN];   /* Period means, oldest at head once full */
+    uint8_t head;                    /* Next slot to overwrite */
+    uint8_t count;                   /* Entries in the ring (<= LEN) */
+    int32_t acc;                     /* Sum of samples in the open period */
+    uint16_t accCount;               /* Samples in acc */
+    uint32_t periodStart;            /* Timestamp of the first sample in acc */
+} TempHistory_t;
+
+/* ========== Function Prototypes ========== */
+
+/**
+ * @brief Clear the ring and the open period
+ * @param hist: History instance
+ */
+void TempHistory_Init(TempHistory_t *hist);
+
+/**
+ * @brief Accumulate one (filtered) sample
+ * @param hist: History instance
+ * @param sample: Sample with its timestamp
+ * @retval 1 if a period closed and a new entry was pushed, 0 otherwise
+ */
+uint8_t TempHistory_Update(TempHistory_t *hist, TempSample_t sample);
+
+/**
+ * @brief Entry by age
+ * @param hist: History instance
+ * @param index: 0 = oldest, count - 1 = newest
+ * @retval Period mean (Q8.8 degC); 0 if index >= count
+ */
+Temp_t TempHistory_Get(const TempHistory_t *hist, uint8_t index);
+
+#endif /* TEMP_HISTORY_H_ */
@@ -0,0 +1,69 @@
+/**
+  ******************************************************************************
+  * @file    temp_trend.h
+  * @brief   Temperature trend: least-squares slope over a sliding window
+  * @details Fits y = a + b*k over the last TEMP_TREND_WINDOW filtered
+  *          samples (k = sample index). The sums are updated in O(1) per
+  *          sample, the slope is scaled to degC/min with the mean sample
+  *          interval taken from the timestamps.
+  ******************************************************************************
+  */
+
+#ifndef TEMP_TREND_H_
+#define TEMP_TREND_H_
+
+#include <stdint.h>
+#include "global_def.h"
+#include "temp_filter.h"
+
+/* ========== Trend Configuration ========== */
+#define TEMP_TREND_WINDOW        32   /* Samples in the fit (~24 s at 750 ms) */
+#ifndef TEMP_TREND_FEEDFORWARD
+#define TEMP_TREND_FEEDFORWARD   0    /* 1: Task_Control may switch the fan on early (opt-in per board) */
+#endif
+#define TEMP_TREND_HORIZON_S     60   /* Look-ahead for the feed-forward term */
+
+/* ========== Data Types ========== */
+/* Estimator state, one instance per sensor */
+typedef struct {
+    Temp_t window[TEMP_TREND_WINDOW];      /* Ring of samples, oldest at head once full */
+    uint32_t times[TEMP_TREND_WINDOW];     /* Timestamps matching window[] */
+    uint8_t head;                          /* Next slot to overwrite */
+    uint8_t count;                         /* Samples in the window (<= N) */
+    int32_t sumY;                          /* sum(y_k) */
+    int32_t sumKY;                         /* sum(k * y_k), k = 0 for the oldest */
+    Temp_t slope;                          /* Q8.8 degC/min, refit on each Update */
+} TempTrend_t;
+
+/* ========== Function Prototypes ========== */
+
+/**
+ * @brief Clear the window
+ * @param trend: Estimator instance
+ */
+void TempTrend_Init(TempTrend_t *trend);
+
+/**
+ * @brief Add one (filtered) sample
+ * @param trend: Estimator instance
+ * @param sample: Sample with its timestamp
+ */
+void TempTrend_Update(TempTrend_t *trend, TempSample_t sample);
+
+/**
+ * @brief Current slope (cached, no division)
+ * @param trend: Estimator instance
+ * @retval Slope in Q8.8 degC/min, 0 until at least 2 samples are available
+ */
+Temp_t TempTrend_Slope(const TempTrend_t *trend);
+
+/**
+ * @brief Extrapolate a temperature along the current slope
+ * @param trend: Estimator instance
+ * @param current: Temperature now (Q8.8 degC)
+ * @param horizonS: Look-ahead in seconds
+ * @retval Predicted temperature (Q8.8 degC, saturated)
+ */
+Temp_t TempTrend_Predict(const TempTrend_t *trend, Temp_t current, uint16_t horizonS);
+
+#endif /* TEMP_TREND_H_ */
@@ -1,4 +1,30 @@
-#include "ds18b20.h"
+#include "DS18B20.h"
+#include "eeprom.h"
+#if DS18B20_TRANSPORT == DS18B20_TRANSPORT_TIM
+#include "onewire_tim.h"
+#include <string.h>
+#elif DS18B20_TRANSPORT == DS18B20_TRANSPORT_UART
+#include "onewire_uart.h"
+#include <string.h>
+#endif
+
+// --- Dallas/Maxim CRC8 (x^8 + x^5 + x^4 + 1), nibble lookup tables ---
+// CRC is linear, so crc(x) = lo[x & 0x0F] ^ hi[x >> 4]: 32 bytes instead of
+// a 256-byte table, and two lookups per byte instead of 8 shifts.
+// Tables are placed in RAM (.data, copied from flash by the startup code) next
+// to DS18B20_CRC8 (.RamFunc): no flash wait states. They stay const, so a
+// stray write is a compile error rather than a silently broken CRC.
+#define CRC8_TABLE_SECTION(name) __attribute__((section(".data." name)))
+
+static const uint8_t crc8_lo[16] CRC8_TABLE_SECTION("crc8_lo") = {
+    0x00, 0x5E, 0xBC, 0xE2, 0x61, 0x3F, 0xDD, 0x83,
+    0xC2, 0x9C, 0x7E, 0x20, 0xA3, 0xFD, 0x1F, 0x41
+};
+
+static const uint8_t crc8_hi[16] CRC8_TABLE_SECTION("crc8_hi") = {
+    0x00, 0x9D, 0x23, 0xBE, 0x46, 0xDB, 0x65, 0xF8,
+    0x8C, 0x11, 0xAF, 0x32, 0xCA, 0x57, 0xE9, 0x74
+};
 
 // --- Helper: Microsecond Delay using DWT ---
 void DS18B20_Init_MicroTimer(void) {
@@ -7,90 +33,819 @@ void DS18B20_Init_MicroTimer(void) {
     DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 }
 
-static void delay_us(uint32_t us) {
+// --- Strong pull-up cho cảm biến parasite power ---
+// Trong lúc Convert T, cảm biến parasite lấy nguồn từ DQ: điện trở kéo lên
+// 4.7k không đủ dòng (~1.5 mA) nên chân DQ phải được lái push-pull mức 1
+// trong vòng 10 us sau bit cuối của lệnh, đến khi chuyển đổi xong.
+// Khi đang giữ strong pull-up bus bị khóa: không giao dịch nào được chạy.
+#if DS18B20_TRANSPORT == DS18B20_TRANSPORT_UART
+#define OW_DQ_PORT  ONEWIRE_UART_PORT
+#define OW_DQ_PIN   ONEWIRE_UART_PIN
+#else
+#define OW_DQ_PORT  DS18B20_PORT
+#define OW_DQ_PIN   DS18B20_PIN
+#endif
+
+static volatile uint8_t spuActive = 0;
+static uint32_t spuSavedMode;           // 4 bit CNF/MODE của chân trước khi bật
+
+static volatile uint32_t *OW_PinConfigReg(uint32_t *shift) {
+    uint32_t pos = 31U - __CLZ(OW_DQ_PIN);
+    *shift = (pos & 7U) * 4U;
+    return (pos < 8U) ? &OW_DQ_PORT->CRL : &OW_DQ_PORT->CRH;
+}
+
+static void OW_StrongPullupOn(void) {
+    uint32_t shift;
+    volatile uint32_t *cr = OW_PinConfigReg(&shift);
+    OW_DQ_PORT->BSRR = OW_DQ_PIN;                       // ODR = 1 trước khi đổi mode
+    spuSavedMode = (*cr >> shift) & 0xFU;
+    *cr = (*cr & ~(0xFU << shift)) | (0x3U << shift);   // Output push-pull 50 MHz
+    spuActive = 1;
+}
+
+static void OW_StrongPullupOff(void) {
+    uint32_t shift;
+    volatile uint32_t *cr = OW_PinConfigReg(&shift);
+    if (!spuActive) return;
+    *cr = (*cr & ~(0xFU << shift)) | (spuSavedMode << shift);
+    spuActive = 0;
+}
+
+uint8_t DS18B20_IsBusLocked(void) {
+    return spuActive;
+}
+
+// --- Đo thời gian chặn ngắt ---
+// Độ trễ ngắt tối đa mà driver gây thêm cho phần còn lại của hệ thống =
+// đoạn critical section dài nhất (chu kỳ CPU, /72 ra us ở 72 MHz).
+static uint32_t irqMaskMaxCycles = 0;
+
+uint32_t DS18B20_GetIrqMaskMaxCycles(void) {
+    return irqMaskMaxCycles;
+}
+
+void DS18B20_ResetIrqMaskStats(void) {
+    irqMaskMaxCycles = 0;
+}
+
+#if DS18B20_TRANSPORT == DS18B20_TRANSPORT_GPIO
+// Ràng buộc datasheet kiểm được lúc biên dịch (chưa tính độ trễ thực thi)
+#if DS18B20_T_RSTL_US < 480 || (DS18B20_T_PRESENCE_US + DS18B20_T_RSTH_US) < 480
+#error "Reset: t_RSTL và t_RSTH phải >= 480 us"
+#endif
+#if DS18B20_T_PRESENCE_US < 60 || DS18B20_T_PRESENCE_US > 75
+#error "Presence: phải lấy mẫu trong 60..75 us sau khi nhả bus"
+#endif
+#if DS18B20_T_LOW1_US < 1 || DS18B20_T_LOW1_US >= 15
+#error "Write-1: thời gian low phải trong 1..15 us"
+#endif
+#if DS18B20_T_LOW0_US < 60 || DS18B20_T_LOW0_US > 120 || DS18B20_T_SLOT_US < 60
+#error "Write-0 / slot: phải trong 60..120 us"
+#endif
+#if (DS18B20_T_RDLOW_US + DS18B20_T_RDV_US) >= 15
+#error "Read: phải lấy mẫu trước 15 us tính từ sườn xuống"
+#endif
+
+// Các hàm định thời slot chạy từ RAM (__RAM_FUNC -> .RamFunc, được startup
+// chép cùng .data): ở 72 MHz flash có 2 wait state, prefetch miss làm vòng
+// chờ DWT và thời điểm ghi BSRR bị lệch vài chu kỳ tùy vị trí code.
+// Các helper inline cũng mang __RAM_FUNC vì bản Debug (-O0) không inline.
+#ifndef DS18B20_PHY_EXTERNAL
+static __RAM_FUNC void delay_us(uint32_t us) {
     uint32_t startTick = DWT->CYCCNT;
     uint32_t delayTicks = us * (SystemCoreClock / 1000000);
     while ((DWT->CYCCNT - startTick) < delayTicks);
 }
 
-// --- Helper: Set GPIO Mode ---
-static void Set_Pin_Output(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
-    GPIO_InitTypeDef GPIO_InitStruct = {0};
-    GPIO_InitStruct.Pin = GPIO_Pin;
-    GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD; // Open Drain
-    GPIO_InitStruct.Pull = GPIO_NOPULL;
-    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
-    HAL_GPIO_Init(GPIOx, &GPIO_InitStruct);
+// --- 1-Wire PHY: chân luôn ở chế độ Open-Drain ---
+// Chân được cấu hình một lần trong DS18B20_Init(). Sau đó mỗi thao tác chỉ là
+// một lần ghi BSRR (kéo xuống 0 / nhả bus) hoặc một lần đọc IDR, không gọi
+// HAL_GPIO_Init trong từng bit nên thời gian slot không bị jitter.
+static inline __RAM_FUNC void OW_Low(void) {
+    DS18B20_PORT->BSRR = (uint32_t)DS18B20_PIN << 16; // ODR = 0 -> kéo bus xuống
 }
 
-static void Set_Pin_Input(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
-    GPIO_InitTypeDef GPIO_InitStruct = {0};
-    GPIO_InitStruct.Pin = GPIO_Pin;
-    GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
-    GPIO_InitStruct.Pull = GPIO_NOPULL;
-    HAL_GPIO_Init(GPIOx, &GPIO_InitStruct);
+static inline __RAM_FUNC void OW_Release(void) {
+    DS18B20_PORT->BSRR = DS18B20_PIN; // ODR = 1 -> Open-Drain nhả bus, điện trở kéo lên
+}
+
+static inline __RAM_FUNC uint8_t OW_Sample(void) {
+    return (DS18B20_PORT->IDR & DS18B20_PIN) != 0;
+}
+#else
+#define OW_Low()        DS18B20_PhyLow()
+#define OW_Release()    DS18B20_PhyRelease()
+#define OW_Sample()     DS18B20_PhySample()
+#define delay_us(us)    DS18B20_PhyDelayUs(us)
+#endif /* DS18B20_PHY_EXTERNAL */
+
+// --- Critical section theo slot ---
+// Chỉ chặn ngắt trong phần slot mà một ngắt chen vào sẽ làm sai bit:
+// low của write-1 (phải < 15 us), low + lấy mẫu của read slot, và cửa sổ
+// presence. Low 60 us của write-0 được phép kéo dài tới 120 us nên không chặn.
+// Có thể lồng nhau (OW_WriteByteSpu bọc OW_WriteBit): chỉ tầng ngoài cùng
+// (PRIMASK trước đó = 0) ghi mốc bắt đầu và đo, tầng trong không ghi đè mốc.
+static uint32_t owMaskStart;
+
+static inline __RAM_FUNC uint32_t OW_CriticalEnter(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (!primask) owMaskStart = DWT->CYCCNT;
+    return primask;
+}
+
+static inline __RAM_FUNC void OW_CriticalExit(uint32_t primask) {
+    if (!primask) {
+        uint32_t cycles = DWT->CYCCNT - owMaskStart;
+        if (cycles > irqMaskMaxCycles) irqMaskMaxCycles = cycles;
+    }
+    __set_PRIMASK(primask);
+}
+
+static __RAM_FUNC void OW_WriteBit(uint8_t bit) {
+    if (bit) { // Write 1
+        uint32_t primask = OW_CriticalEnter();
+        OW_Low();
+        delay_us(DS18B20_T_LOW1_US);
+        OW_Release();
+        OW_CriticalExit(primask);
+        delay_us(DS18B20_T_SLOT_US - DS18B20_T_LOW1_US);
+    } else { // Write 0
+        OW_Low();
+        delay_us(DS18B20_T_LOW0_US);
+        OW_Release();
+        delay_us(DS18B20_T_REC_US); // Recovery
+    }
+}
+
+static __RAM_FUNC uint8_t OW_ReadBit(void) {
+    uint8_t bit;
+    uint32_t primask = OW_CriticalEnter();
+    OW_Low();
+    delay_us(DS18B20_T_RDLOW_US);
+    OW_Release();
+    delay_us(DS18B20_T_RDV_US); // Lấy mẫu ở ~10us, trước giới hạn 15us của datasheet
+    bit = OW_Sample();
+    OW_CriticalExit(primask);
+    delay_us(DS18B20_T_RDREST_US);
+    return bit;
+}
+
+static void OW_ReadBytes(uint8_t *buf, uint8_t length) {
+    while (length--) {
+        *buf++ = DS18B20_Read();
+    }
+}
+
+// Ghi byte rồi bật strong pull-up ngay sau slot cuối: chặn ngắt trong slot
+// cuối để khoảng trống trước strong pull-up chỉ còn vài chu kỳ (< 10 us).
+static void OW_WriteByteSpu(uint8_t data) {
+    uint32_t primask;
+    for (int i = 0; i < 7; i++) {
+        OW_WriteBit(data & 0x01);
+        data >>= 1;
+    }
+    primask = OW_CriticalEnter();
+    OW_WriteBit(data & 0x01);
+    OW_StrongPullupOn();
+    OW_CriticalExit(primask);
 }
 
 // --- DS18B20 Functions ---
 
+void DS18B20_Init(void) {
+#ifndef DS18B20_PHY_EXTERNAL
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+    DS18B20_Init_MicroTimer();
+
+    OW_Release(); // Đặt ODR = 1 trước để bus không bị kéo xuống khi đổi mode
+    GPIO_InitStruct.Pin = DS18B20_PIN;
+    GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD; // Open Drain: vừa ghi vừa đọc được IDR
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+    HAL_GPIO_Init(DS18B20_PORT, &GPIO_InitStruct);
+#else
+    OW_Release();
+#endif
+}
+
 uint8_t DS18B20_Start(void) {
     uint8_t response = 0;
-    Set_Pin_Output(DS18B20_PORT, DS18B20_PIN);
-    HAL_GPIO_WritePin(DS18B20_PORT, DS18B20_PIN, 0);
-    delay_us(480); // Reset pulse
-    Set_Pin_Input(DS18B20_PORT, DS18B20_PIN);
-    delay_us(80);
-    if (!(HAL_GPIO_ReadPin(DS18B20_PORT, DS18B20_PIN))) response = 1; // Presence detected
+    uint32_t primask;
+    OW_Low();
+    delay_us(DS18B20_T_RSTL_US); // Reset pulse
+    // Presence chắc chắn ở mức 0 chỉ trong 60..75 us sau khi nhả: chặn ngắt
+    // từ lúc nhả đến lúc lấy mẫu (đoạn chặn dài nhất của driver)
+    primask = OW_CriticalEnter();
+    OW_Release();
+    delay_us(DS18B20_T_PRESENCE_US);
+    if (!OW_Sample()) response = 1; // Presence detected
     else response = 0;
-    delay_us(400);
+    OW_CriticalExit(primask);
+    delay_us(DS18B20_T_RSTH_US);
     return response;
 }
 
 void DS18B20_Write(uint8_t data) {
-    Set_Pin_Output(DS18B20_PORT, DS18B20_PIN);
     for (int i = 0; i < 8; i++) {
-        if ((data & (1 << i)) != 0) { // Write 1
-            Set_Pin_Output(DS18B20_PORT, DS18B20_PIN);
-            HAL_GPIO_WritePin(DS18B20_PORT, DS18B20_PIN, 0);
-            delay_us(1);
-            Set_Pin_Input(DS18B20_PORT, DS18B20_PIN); // Release line
-            delay_us(60);
-        } else { // Write 0
-            Set_Pin_Output(DS18B20_PORT, DS18B20_PIN);
-            HAL_GPIO_WritePin(DS18B20_PORT, DS18B20_PIN, 0);
-            delay_us(60);
-            Set_Pin_Input(DS18B20_PORT, DS18B20_PIN);
-        }
+        OW_WriteBit(data & 0x01);
+        data >>= 1;
     }
 }
 
 uint8_t DS18B20_Read(void) {
     uint8_t value = 0;
-    Set_Pin_Input(DS18B20_PORT, DS18B20_PIN);
     for (int i = 0; i < 8; i++) {
-        Set_Pin_Output(DS18B20_PORT, DS18B20_PIN);
-        HAL_GPIO_WritePin(DS18B20_PORT, DS18B20_PIN, 0);
-        delay_us(2);
-        Set_Pin_Input(DS18B20_PORT, DS18B20_PIN);
-        delay_us(10); // Wait for valid data
-        if (HAL_GPIO_ReadPin(DS18B20_PORT, DS18B20_PIN)) {
+        if (OW_ReadBit()) {
             value |= (1 << i);
         }
-        delay_us(50);
     }
     return value;
 }
 
+#elif DS18B20_TRANSPORT == DS18B20_TRANSPORT_TIM
+// --- 1-Wire qua TIM1 + DMA: CPU chỉ nhận 1 ngắt khi xong cả giao dịch ---
+
+// Đọc nhiều byte trong MỘT giao dịch DMA (tối đa ONEWIRE_TIM_MAX_BITS / 8 byte)
+static void OW_ReadBytes(uint8_t *buf, uint8_t length) {
+    uint8_t ones[ONEWIRE_TIM_MAX_BITS / 8];
+    memset(ones, 0xFF, sizeof(ones));
+    while (length) {
+        uint8_t chunk = (length > sizeof(ones)) ? sizeof(ones) : length;
+        OneWire_Tim_Transfer(ones, buf, chunk * 8);
+        buf += chunk;
+        length -= chunk;
+    }
+}
+
+static void OW_WriteBit(uint8_t bit) {
+    OneWire_Tim_Transfer(&bit, NULL, 1);
+}
+
+static uint8_t OW_ReadBit(void) {
+    uint8_t tx = 1, rx = 0;
+    OneWire_Tim_Transfer(&tx, &rx, 1);
+    return rx & 0x01;
+}
+
+// Giao dịch chạy bằng ngắt nên không chặn ngắt được: strong pull-up bật
+// ngay khi ngắt kết thúc giao dịch đánh thức CPU (vài us sau slot cuối).
+static void OW_WriteByteSpu(uint8_t data) {
+    DS18B20_Write(data);
+    OW_StrongPullupOn();
+}
+
+// --- DS18B20 Functions ---
+
+void DS18B20_Init(void) {
+    DS18B20_Init_MicroTimer();
+    OneWire_Tim_Init();
+}
+
+uint8_t DS18B20_Start(void) {
+    return OneWire_Tim_Reset();
+}
+
+void DS18B20_Write(uint8_t data) {
+    OneWire_Tim_Transfer(&data, NULL, 8);
+}
+
+uint8_t DS18B20_Read(void) {
+    uint8_t tx = 0xFF; // Read slot = write-1 slot
+    uint8_t value = 0;
+    OneWire_Tim_Transfer(&tx, &value, 8);
+    return value;
+}
+
+#elif DS18B20_TRANSPORT == DS18B20_TRANSPORT_UART
+// --- 1-Wire qua USART3 half-duplex: mỗi time slot là một frame UART ---
+
+// Đọc nhiều byte trong MỘT cặp giao dịch DMA TX/RX
+static void OW_ReadBytes(uint8_t *buf, uint8_t length) {
+    uint8_t ones[ONEWIRE_UART_MAX_BITS / 8];
+    memset(ones, 0xFF, sizeof(ones));
+    while (length) {
+        uint8_t chunk = (length > sizeof(ones)) ? sizeof(ones) : length;
+        OneWire_Uart_Transfer(ones, buf, chunk * 8);
+        buf += chunk;
+        length -= chunk;
+    }
+}
+
+static void OW_WriteBit(uint8_t bit) {
+    OneWire_Uart_Transfer(&bit, NULL, 1);
+}
+
+static uint8_t OW_ReadBit(void) {
+    uint8_t tx = 1, rx = 0;
+    OneWire_Uart_Transfer(&tx, &rx, 1);
+    return rx & 0x01;
+}
+
+// Giao dịch chạy bằng ngắt nên không chặn ngắt được: strong pull-up bật
+// ngay khi ngắt kết thúc giao dịch đánh thức CPU (vài us sau slot cuối).
+static void OW_WriteByteSpu(uint8_t data) {
+    DS18B20_Write(data);
+    OW_StrongPullupOn();
+}
+
+// --- DS18B20 Functions ---
+
+void DS18B20_Init(void) {
+    DS18B20_Init_MicroTimer();
+    OneWire_Uart_Init();
+}
+
+uint8_t DS18B20_Start(void) {
+    return OneWire_Uart_Reset();
+}
+
+void DS18B20_Write(uint8_t data) {
+    OneWire_Uart_Transfer(&data, NULL, 8);
+}
+
+uint8_t DS18B20_Read(void) {
+    uint8_t tx = 0xFF; // Read slot = write-1 slot
+    uint8_t value = 0;
+    OneWire_Uart_Transfer(&tx, &value, 8);
+    return value;
+}
+
+#else
+#error "DS18B20_TRANSPORT không hợp lệ"
+#endif
+
+__RAM_FUNC uint8_t DS18B20_CRC8(const uint8_t *data, uint8_t length) {
+    uint8_t crc = 0;
+    while (length--) {
+        uint8_t x = crc ^ *data++;
+        crc = crc8_lo[x & 0x0F] ^ crc8_hi[x >> 4];
+    }
+    return crc;
+}
+
+#if DS18B20_CRC_BENCH
+// Bản bitwise kinh điển (8 lần dịch/byte), chỉ dùng làm mốc so sánh
+static __RAM_FUNC uint8_t CRC8_Bitwise(const uint8_t *data, uint8_t length) {
+    uint8_t crc = 0;
+    while (length--) {
+        uint8_t b = *data++;
+        for (uint8_t i = 0; i < 8; i++) {
+            uint8_t mix = (crc ^ b) & 0x01;
+            crc >>= 1;
+            if (mix) crc ^= 0x8C;
+            b >>= 1;
+        }
+    }
+    return crc;
+}
+
+// Đo số chu kỳ DWT cho 1 scratchpad (8 byte) với mỗi cách tính, lấy trung bình
+// DS18B20_CRC_BENCH_RUNS lần, ngắt bị chặn để không lẫn thời gian ISR.
+// Trả về 1 nếu hai cách cho cùng kết quả.
+uint8_t DS18B20_CRC8_Bench(uint32_t *bitwiseCycles, uint32_t *tableCycles) {
+    static const uint8_t sample[8] = { 0x91, 0x01, 0x4B, 0x46, 0x7F, 0xFF, 0x0F, 0x10 };
+    volatile uint8_t sink = 0;
+    uint8_t ref = CRC8_Bitwise(sample, 8);
+    uint32_t primask = __get_PRIMASK();
+    uint32_t t0, t1, t2;
+
+    __disable_irq();
+    t0 = DWT->CYCCNT;
+    for (uint16_t i = 0; i < DS18B20_CRC_BENCH_RUNS; i++) sink ^= CRC8_Bitwise(sample, 8);
+    t1 = DWT->CYCCNT;
+    for (uint16_t i = 0; i < DS18B20_CRC_BENCH_RUNS; i++) sink ^= DS18B20_CRC8(sample, 8);
+    t2 = DWT->CYCCNT;
+    __set_PRIMASK(primask);
+    (void)sink;
+
+    *bitwiseCycles = (t1 - t0) / DS18B20_CRC_BENCH_RUNS;
+    *tableCycles = (t2 - t1) / DS18B20_CRC_BENCH_RUNS;
+    return ref == DS18B20_CRC8(sample, 8);
+}
+#endif
+
+// Reset + chọn cảm biến: Match ROM nếu có rom, Skip ROM nếu rom == NULL
+uint8_t DS18B20_Select(const uint8_t *rom) {
+    if (spuActive) return 0;        // Đang strong pull-up: không được chạm vào bus
+    if (!DS18B20_Start()) return 0; // Không có cảm biến trên bus
+    if (rom == NULL) {
+        DS18B20_Write(0xCC); // Skip ROM
+    } else {
+        DS18B20_Write(0x55); // Match ROM
+        for (int i = 0; i < 8; i++) {
+            DS18B20_Write(rom[i]);
+        }
+    }
+    return 1;
+}
+
+// Read Power Supply (0xB4): cảm biến parasite kéo read slot xuống 0.
+// rom == NULL hỏi cả bus (1 nếu có ít nhất một cảm biến parasite).
+uint8_t DS18B20_IsParasite(const uint8_t *rom) {
+    if (!DS18B20_Select(rom)) return 0;
+    DS18B20_Write(0xB4);
+    return !OW_ReadBit();
+}
+
+// Đọc đủ 9 byte scratchpad và kiểm tra CRC (byte 8 là CRC của 8 byte đầu)
+// Byte 4 (config) luôn có dạng 0RR11111: bus bị kẹt mức 0 cho toàn 0x00,
+// CRC vẫn đúng nên phải loại riêng trường hợp này.
+HAL_StatusTypeDef DS18B20_ReadScratchpad(const uint8_t *rom, uint8_t *scratchpad) {
+    if (!DS18B20_Select(rom)) return HAL_ERROR;
+    DS18B20_Write(0xBE); // Read Scratchpad
+
+    OW_ReadBytes(scratchpad, DS18B20_SCRATCHPAD_SIZE);
+    if (DS18B20_CRC8(scratchpad, DS18B20_SCRATCHPAD_SIZE - 1) != scratchpad[DS18B20_SCRATCHPAD_SIZE - 1]) {
+        return HAL_ERROR;
+    }
+    if ((scratchpad[4] & 0x9F) != 0x1F) {
+        return HAL_ERROR;
+    }
+    return HAL_OK;
+}
+
+// --- ROM Search (Maxim AN187) ---
+// Tìm tối đa maxCount ROM trên bus với lệnh cmd (0xF0 Search ROM).
+// Trả về số ROM hợp lệ (đã kiểm CRC) tìm được.
+static uint8_t OW_Search(uint8_t cmd, uint8_t roms[][8], uint8_t maxCount) {
+    uint8_t rom[8] = {0};
+    uint8_t lastDiscrepancy = 0;
+    uint8_t count = 0;
+
+    if (spuActive) return 0;
+
+    while (count < maxCount) {
+        uint8_t lastZero = 0;
+
+        if (!DS18B20_Start()) break;
+        DS18B20_Write(cmd);
+
+        for (uint8_t bitNo = 1; bitNo <= 64; bitNo++) {
+            uint8_t byteIdx = (bitNo - 1) >> 3;
+            uint8_t mask = 1 << ((bitNo - 1) & 7);
+            uint8_t idBit = OW_ReadBit();
+            uint8_t cmpBit = OW_ReadBit();
+            uint8_t dir;
+
+            if (idBit && cmpBit) return count; // Không thiết bị nào trả lời
+            if (idBit != cmpBit) {
+                dir = idBit;
+            } else { // Xung đột: các ROM khác nhau ở bit này
+                if (bitNo < lastDiscrepancy) dir = (rom[byteIdx] & mask) != 0;
+                else dir = (bitNo == lastDiscrepancy);
+                if (!dir) lastZero = bitNo;
+            }
+            if (dir) rom[byteIdx] |= mask;
+            else rom[byteIdx] &= ~mask;
+            OW_WriteBit(dir);
+        }
+
+        if (DS18B20_CRC8(rom, 7) != rom[7]) break;
+        for (int i = 0; i < 8; i++) roms[count][i] = rom[i];
+        count++;
+
+        lastDiscrepancy = lastZero;
+        if (lastDiscrepancy == 0) break; // Đã duyệt hết cây
+    }
+    return count;
+}
+
+uint8_t DS18B20_SearchRom(uint8_t roms[][8], uint8_t maxCount) {
+    return OW_Search(0xF0, roms, maxCount);
+}
+
+// Alarm Search (0xEC): chỉ các cảm biến có cờ alarm từ lần chuyển đổi gần
+// nhất (T <= TL hoặc T >= TH) tham gia dò, bus rỗng chỉ tốn 1 reset + 10 bit.
+uint8_t DS18B20_AlarmSearch(uint8_t roms[][8], uint8_t maxCount) {
+    return OW_Search(0xEC, roms, maxCount);
+}
+
+// Ghi TH/TL vào scratchpad (không Copy Scratchpad sang EEPROM của cảm biến
+// để tránh mòn EEPROM; sau khi mất nguồn giá trị cũ được nạp lại và
+// DS18B20_ReadFleet sẽ ghi lại). Byte config giữ nguyên độ phân giải hiện tại.
+HAL_StatusTypeDef DS18B20_SetAlarm(DS18B20_Sensor_t *sensor, int8_t low, int8_t high) {
+    uint8_t scratchpad[DS18B20_SCRATCHPAD_SIZE];
+
+    if (DS18B20_ReadScratchpad(sensor->rom, scratchpad) != HAL_OK) return HAL_ERROR;
+    if ((int8_t)scratchpad[2] != high || (int8_t)scratchpad[3] != low) {
+        if (!DS18B20_Select(sensor->rom)) return HAL_ERROR;
+        DS18B20_Write(0x4E); // Write Scratchpad: TH, TL, config
+        DS18B20_Write((uint8_t)high);
+        DS18B20_Write((uint8_t)low);
+        DS18B20_Write(scratchpad[4]);
+
+        // Đọc lại để chắc chắn đã ghi đúng
+        if (DS18B20_ReadScratchpad(sensor->rom, scratchpad) != HAL_OK) return HAL_ERROR;
+        if ((int8_t)scratchpad[2] != high || (int8_t)scratchpad[3] != low) return HAL_ERROR;
+    }
+    sensor->alarmHigh = high;
+    sensor->alarmLow = low;
+    return HAL_OK;
+}
+
+// --- Theo dõi tình trạng cảm biến ---
+
+static uint8_t RomEqual(const uint8_t *a, const uint8_t *b) {
+    for (int i = 0; i < 8; i++) {
+        if (a[i] != b[i]) return 0;
+    }
+    return 1;
+}
+
+// Dò lại bus và gộp với danh sách cũ: ROM còn thấy giữ nguyên trạng thái,
+// ROM mới được thêm vào, ROM không còn thấy bị đánh dấu ABSENT.
+uint8_t DS18B20_Enumerate(DS18B20_Sensor_t *sensors, uint8_t count, uint8_t maxCount) {
+    uint8_t found[DS18B20_MAX_SENSORS][8];
+    uint8_t nFound = DS18B20_SearchRom(found, DS18B20_MAX_SENSORS);
+
+    for (uint8_t s = 0; s < count; s++) {
+        uint8_t seen = 0;
+        for (uint8_t f = 0; f < nFound; f++) {
+            if (RomEqual(sensors[s].rom, found[f])) seen = 1;
+        }
+        if (!seen) sensors[s].status = DS18B20_STATUS_ABSENT;
+    }
+
+    for (uint8_t f = 0; f < nFound; f++) {
+        uint8_t known = 0;
+        for (uint8_t s = 0; s < count; s++) {
+            if (RomEqual(sensors[s].rom, found[f])) known = 1;
+        }
+        if (!known && count < maxCount) {
+            DS18B20_Sensor_t *n = &sensors[count++];
+            for (int i = 0; i < 8; i++) n->rom[i] = found[f][i];
+            n->status = DS18B20_STATUS_ABSENT; // Chưa có lần đọc hợp lệ nào
+            n->crcErrors = 0;
+            n->stuckCount = 0;
+            for (int i = 0; i < DS18B20_SCRATCHPAD_SIZE; i++) n->lastScratchpad[i] = 0;
+            n->lastRaw = 0;
+            n->temp = 0;
+            n->calOffset = 0;               // Chưa hiệu chuẩn: temp = raw
+            n->calGain = DS18B20_CAL_GAIN_ONE;
+            n->alarmHigh = 0;               // Chưa biết TH/TL: đọc mỗi chu kỳ
+            n->alarmLow = 0;
+            n->quietCycles = 0;
+        }
+    }
+    return count;
+}
+
+// Cảm biến còn sống phải kéo read slot xuống 0 ngay sau Convert T (đang chuyển đổi).
+// Trả 1 nếu thấy bận, 0 nếu không (cảm biến không chuyển đổi), 0xFF nếu không
+// kiểm được (không trả lời, hoặc parasite: không được tạo read slot khi chuyển đổi).
+static uint8_t DS18B20_ProbeConversion(const uint8_t *rom) {
+    if (DS18B20_IsParasite(rom)) return 0xFF;
+    if (!DS18B20_Select(rom)) return 0xFF;
+    DS18B20_Write(0x44); // Convert T riêng cảm biến này, kết quả dùng ở chu kỳ sau
+    return !OW_ReadBit();
+}
+
+// raw (Q4) * gain / 2^14 -> Q8.8, làm tròn
+static int32_t DS18B20_ApplyGain(int16_t raw, int16_t gain) {
+    int32_t t = (int32_t)raw * (1 << (TEMP_FRAC_BITS - 4));
+    return ((t * gain) + (1 << 13)) >> 14;
+}
+
+// Đọc một cảm biến theo ROM và cập nhật trạng thái. Chỉ trả HAL_OK (và cập
+// nhật sensor->temp) khi giá trị dùng được cho điều khiển.
+HAL_StatusTypeDef DS18B20_ReadSensor(DS18B20_Sensor_t *sensor) {
+    uint8_t scratchpad[DS18B20_SCRATCHPAD_SIZE];
+    HAL_StatusTypeDef status = HAL_ERROR;
+    uint8_t wasOk = (sensor->status == DS18B20_STATUS_OK);
+
+    for (int attempt = 0; attempt < DS18B20_READ_RETRIES && status != HAL_OK; attempt++) {
+        for (int i = 0; i < DS18B20_SCRATCHPAD_SIZE; i++) scratchpad[i] = 0xFF;
+        status = DS18B20_ReadScratchpad(sensor->rom, scratchpad);
+        if (status != HAL_OK && sensor->crcErrors < 0xFF) sensor->crcErrors++;
+    }
+    if (status != HAL_OK) {
+        // Toàn 0xFF: không ai kéo bus trong các read slot -> cảm biến đã bị rút
+        // Toàn 0x00: bus bị giữ ở mức 0 (CRC vẫn đúng, byte config sai) -> STUCK
+        uint8_t allOnes = 1, allZeros = 1;
+        for (int i = 0; i < DS18B20_SCRATCHPAD_SIZE; i++) {
+            if (scratchpad[i] != 0xFF) allOnes = 0;
+            if (scratchpad[i] != 0x00) allZeros = 0;
+        }
+        sensor->status = allOnes ? DS18B20_STATUS_ABSENT :
+                         allZeros ? DS18B20_STATUS_STUCK : DS18B20_STATUS_CRC_ERROR;
+        return HAL_ERROR;
+    }
+
+    int16_t raw = (int16_t)((scratchpad[1] << 8) | scratchpad[0]);
+    sensor->alarmHigh = (int8_t)scratchpad[2]; // Sau POR cảm biến nạp lại TH/TL từ EEPROM
+    sensor->alarmLow = (int8_t)scratchpad[3];
+
+    // 85 °C là giá trị scratchpad lúc cấp nguồn: chỉ chấp nhận nếu lần đọc
+    // hợp lệ trước đó đã ở gần 85 °C
+    if (raw == DS18B20_RAW_POWER_ON &&
+        (!wasOk || sensor->lastRaw < DS18B20_RAW_POWER_ON - DS18B20_POWER_ON_WINDOW)) {
+        sensor->status = DS18B20_STATUS_POWER_ON_RESET;
+        return HAL_ERROR;
+    }
+
+    // Scratchpad giống hệt nhiều lần là bình thường khi nhiệt độ ổn định, nên
+    // không tự nó là lỗi: chỉ khi đó mới kiểm tra ở mức bus xem cảm biến còn
+    // chuyển đổi không. Cảm biến STUCK được kiểm tra lại ở mỗi lần đọc.
+    uint8_t same = 1;
+    for (int i = 0; i < DS18B20_SCRATCHPAD_SIZE; i++) {
+        if (scratchpad[i] != sensor->lastScratchpad[i]) same = 0;
+        sensor->lastScratchpad[i] = scratchpad[i];
+    }
+    if (!same) {
+        sensor->stuckCount = 0;
+    } else if (sensor->stuckCount < DS18B20_STUCK_LIMIT) {
+        sensor->stuckCount++;
+    }
+    sensor->lastRaw = raw;
+    if (sensor->stuckCount >= DS18B20_STUCK_LIMIT) {
+        if (DS18B20_ProbeConversion(sensor->rom) == 0) {
+            sensor->status = DS18B20_STATUS_STUCK;
+            return HAL_ERROR;
+        }
+        sensor->stuckCount = 0; // Vẫn chuyển đổi: chỉ là nhiệt độ không đổi
+    }
+
+    sensor->status = DS18B20_STATUS_OK;
+    sensor->crcErrors = 0;
+
+    // Hiệu chuẩn hai điểm: temp = raw * gain / 2^14 + offset (làm tròn, bão hòa int16)
+    int32_t t = DS18B20_ApplyGain(raw, sensor->calGain) + sensor->calOffset;
+    if (t > INT16_MAX) t = INT16_MAX;
+    if (t < INT16_MIN) t = INT16_MIN;
+    sensor->temp = (Temp_t)t;
+    return HAL_OK;
+}
+
+// Đọc các cảm biến cần đọc trong chu kỳ này (gọi sau khi Convert T xong):
+// - cảm biến ngoài dải TL..TH (tìm bằng Alarm Search),
+// - cảm biến chưa khỏe hoặc TH/TL chưa đúng dải hiện tại,
+// - cảm biến mustRead (cảm biến đang dùng cho điều khiển, 0xFF = không có),
+// - cảm biến trong dải đã im lặng DS18B20_QUIET_PERIOD chu kỳ.
+// Sau đó ghi TH/TL cho cảm biến khỏe còn sai dải, có hiệu lực từ lần chuyển đổi sau.
+void DS18B20_ReadFleet(DS18B20_Sensor_t *sensors, uint8_t count, int8_t low, int8_t high, uint8_t mustRead) {
+    uint8_t alarmed[DS18B20_MAX_SENSORS][8];
+    uint8_t nAlarmed = DS18B20_AlarmSearch(alarmed, DS18B20_MAX_SENSORS);
+
+    for (uint8_t s = 0; s < count; s++) {
+        DS18B20_Sensor_t *sensor = &sensors[s];
+        uint8_t due = (s == mustRead) ||
+                      (sensor->status != DS18B20_STATUS_OK) ||
+                      (sensor->alarmHigh != high || sensor->alarmLow != low) ||
+                      (++sensor->quietCycles >= DS18B20_QUIET_PERIOD);
+        for (uint8_t a = 0; a < nAlarmed && !due; a++) {
+            if (RomEqual(sensor->rom, alarmed[a])) due = 1;
+        }
+        if (!due) continue;
+
+        sensor->quietCycles = 0;
+        DS18B20_ReadSensor(sensor);
+    }
+
+    for (uint8_t s = 0; s < count; s++) {
+        if (sensors[s].status == DS18B20_STATUS_OK &&
+            (sensors[s].alarmHigh != high || sensors[s].alarmLow != low)) {
+            DS18B20_SetAlarm(&sensors[s], low, high);
+        }
+    }
+}
+
 // Hàm này CHỈ GỬI LỆNH đọc, không delay chờ (để dùng trong FreeRTOS)
 // Bạn cần gọi DS18B20_Start() -> Write(0xCC) -> Write(0x44) -> osDelay(750) -> Gọi hàm này
-float DS18B20_GetTemp(void) {
+// Scratchpad được đọc lại tối đa DS18B20_READ_RETRIES lần nếu sai CRC;
+// *pTemp chỉ được cập nhật khi dữ liệu hợp lệ.
+// Kết quả là số nguyên có dấu Q8.8 (Temp_t), raw của cảm biến là Q4 (1/16 °C).
+HAL_StatusTypeDef DS18B20_GetTemp(Temp_t *pTemp) {
+	uint8_t scratchpad[DS18B20_SCRATCHPAD_SIZE];
+
+	if (pTemp == NULL) return HAL_ERROR;
+
 	// Giả sử cảm biến đã được Start conversion trước đó
-	DS18B20_Start();
-	DS18B20_Write(0xCC); // Skip ROM
-	DS18B20_Write(0xBE); // Read Scratchpad
+	for (int attempt = 0; attempt < DS18B20_READ_RETRIES; attempt++) {
+		if (DS18B20_ReadScratchpad(NULL, scratchpad) == HAL_OK) {
+			int16_t raw = (int16_t)((scratchpad[1] << 8) | scratchpad[0]);
+			*pTemp = (Temp_t)(raw * (1 << (TEMP_FRAC_BITS - 4)));
+			return HAL_OK;
+		}
+	}
+	return HAL_ERROR;
+}
 
-	uint8_t temp_l = DS18B20_Read();
-	uint8_t temp_h = DS18B20_Read();
-	uint16_t temp = (temp_h << 8) | temp_l;
-	return (float)temp / 16.0;
+// --- Giao diện sensor.h ---
+// start(): kiểm tra presence, dò lại bus khi cần, Convert T cho mọi cảm biến
+// ready(): sau Convert T, read slot trả 0 khi đang chuyển đổi và 1 khi xong
+//          (chỉ đúng khi cảm biến được cấp nguồn riêng, không dùng parasite)
+// read():  đọc theo Alarm Search rồi chọn cảm biến khỏe đầu tiên làm cảm biến chính
+static DS18B20_Sensor_t fleet[DS18B20_MAX_SENSORS];
+static uint8_t fleetCount = 0;          // Số cảm biến đã biết (kể cả ABSENT)
+static uint8_t fleetPrimary = 0xFF;     // Cảm biến chính, 0xFF = không có
+static uint8_t fleetRescan = 0;         // Số chu kỳ từ lần dò lại gần nhất
+static uint8_t fleetParasite = 0;       // 1: có cảm biến parasite, cần strong pull-up
+static uint32_t convertTick;            // HAL_GetTick() lúc gửi Convert T
+static int8_t alarmBandLow = 0;
+static int8_t alarmBandHigh = 0;
+
+void DS18B20_SetAlarmBand(int8_t low, int8_t high) {
+    alarmBandLow = low;
+    alarmBandHigh = high;
 }
+
+// Hiệu chuẩn một điểm cho cảm biến chính: giữ gain, chọn offset để lần đọc
+// gần nhất bằng reference, rồi lưu theo ROM vào flash (bảng hiệu chuẩn EEPROM)
+HAL_StatusTypeDef DS18B20_CalibratePrimary(Temp_t reference) {
+    if (fleetPrimary == 0xFF) return HAL_ERROR;
+
+    DS18B20_Sensor_t *sensor = &fleet[fleetPrimary];
+    int32_t offset = (int32_t)reference - DS18B20_ApplyGain(sensor->lastRaw, sensor->calGain);
+    if (offset > DS18B20_CAL_MAX_OFFSET || offset < -DS18B20_CAL_MAX_OFFSET) return HAL_ERROR;
+
+    if (EEPROM_SaveCalibration(sensor->rom, (int16_t)offset, sensor->calGain) != HAL_OK) return HAL_ERROR;
+    sensor->calOffset = (int16_t)offset;
+    sensor->temp = reference;
+    return HAL_OK;
+}
+
+static HAL_StatusTypeDef DS18B20_OpStart(void *ctx) {
+    (void)ctx;
+
+    if (spuActive) return HAL_BUSY;     // Chuyển đổi parasite trước chưa xong
+
+    // Không ai trả lời presence -> mọi cảm biến vắng mặt
+    if (!DS18B20_Start()) {
+        for (uint8_t i = 0; i < fleetCount; i++) fleet[i].status = DS18B20_STATUS_ABSENT;
+        fleetPrimary = 0xFF;
+        return HAL_ERROR;
+    }
+
+    // Hot-plug: dò lại khi chưa biết cảm biến nào hoặc có cảm biến vắng mặt
+    uint8_t anyAbsent = (fleetCount == 0);
+    for (uint8_t i = 0; i < fleetCount; i++) {
+        if (fleet[i].status == DS18B20_STATUS_ABSENT) anyAbsent = 1;
+    }
+    if (anyAbsent && (fleetCount == 0 || ++fleetRescan >= DS18B20_RESCAN_PERIOD)) {
+        fleetRescan = 0;
+        fleetCount = DS18B20_Enumerate(fleet, fleetCount, DS18B20_MAX_SENSORS);
+        // Hệ số hiệu chuẩn đi theo ROM, không theo vị trí trên bus
+        for (uint8_t i = 0; i < fleetCount; i++) {
+            EEPROM_LoadCalibration(fleet[i].rom, &fleet[i].calOffset, &fleet[i].calGain);
+        }
+        fleetParasite = DS18B20_IsParasite(NULL);
+    }
+
+    if (!DS18B20_Select(NULL)) return HAL_ERROR;   // Skip ROM
+    if (fleetParasite) {
+        OW_WriteByteSpu(0x44);  // Convert T + strong pull-up
+    } else {
+        DS18B20_Write(0x44);    // Convert T
+    }
+    convertTick = HAL_GetTick();
+    return HAL_OK;
+}
+
+static uint8_t DS18B20_OpReady(void *ctx) {
+    (void)ctx;
+    if (fleetParasite) {
+        // Không được tạo read slot khi đang cấp nguồn qua DQ: chờ đủ t_CONV
+        if ((HAL_GetTick() - convertTick) < DS18B20_CONV_TIME_MS) return 0;
+        OW_StrongPullupOff();
+        return 1;
+    }
+    return OW_ReadBit();
+}
+
+static HAL_StatusTypeDef DS18B20_OpRead(void *ctx, Temp_t *pTemp) {
+    (void)ctx;
+
+    OW_StrongPullupOff();   // Phòng khi ready() bị bỏ qua
+
+    DS18B20_ReadFleet(fleet, fleetCount, alarmBandLow, alarmBandHigh, fleetPrimary);
+
+    fleetPrimary = 0xFF;
+    for (uint8_t i = 0; i < fleetCount && fleetPrimary == 0xFF; i++) {
+        if (fleet[i].status == DS18B20_STATUS_OK) fleetPrimary = i;
+    }
+    if (fleetPrimary == 0xFF) return HAL_ERROR;
+
+    *pTemp = fleet[fleetPrimary].temp;
+    return HAL_OK;
+}
+
+static SensorHealth_t DS18B20_OpHealth(void *ctx) {
+    (void)ctx;
+    if (fleetPrimary != 0xFF) return SENSOR_HEALTH_OK;
+    for (uint8_t i = 0; i < fleetCount; i++) {
+        if (fleet[i].status != DS18B20_STATUS_ABSENT) return SENSOR_HEALTH_ERROR;
+    }
+    return SENSOR_HEALTH_ABSENT;
+}
+
+const SensorOps_t DS18B20_SensorOps = {
+    "DS18B20",
+    4,              // 12-bit: 1/16 °C
+    DS18B20_OpStart,
+    DS18B20_OpReady,
+    DS18B20_OpRead,
+    DS18B20_OpHealth
+};
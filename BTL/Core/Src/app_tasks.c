@@ -3,9 +3,15 @@
 #include "main.h"
 #include "liquidcrystal_i2c.h"
 #include "DS18B20.h"
+#include "lm75.h"
+#include "sht3x.h"
+#include "sensor.h"
 #include "eeprom.h"
+#include "temp_filter.h"
+#include "temp_trend.h"
+#include "temp_history.h"
+#include "fixfmt.h"
 #include "stm32f1xx_hal.h"
-#include <stdio.h>
 #include <string.h>
 
 /* ========== Task Timing Control ========== */
@@ -14,40 +20,133 @@ static uint32_t task_input_last_time = 0;
 static uint32_t task_control_last_time = 0;
 static uint32_t task_display_last_time = 0;
 
+/* ========== Sensor Filter ========== */
+static TempFilter_t sensor_filter;          // Median + EMA between DS18B20 and thermostat_state
+static TempTrend_t sensor_trend;            // Least-squares slope of the filtered samples
+static TempHistory_t sensor_history;        // Downsampled filtered samples for the sparkline
+
+/* ========== Display ========== */
+static uint16_t display_wire_bytes = 0;     // I2C bytes queued by the last frame (0 when unchanged or still busy)
+static uint32_t display_fmt_cycles = 0;     // DWT cycles spent in the FixFmt_* calls of the last frame
+#define DISPLAY_TREND_ARROW (TEMP_ONE / 10)  // |slope| >= 0.1 degC/min shows an arrow
+#define DISPLAY_SPARKLINE 1                 // History sparkline at the end of line 1 (short mode names)
+#define DISPLAY_SPARK_CELLS (TEMP_HISTORY_LEN / 4)  // 4 history columns per 5-pixel cell
+#define DISPLAY_SPARK_MIN_SPAN (TEMP_ONE / 2)       // Full height is at least 0.5 degC
+#define DISPLAY_FAN_FRAME_MS 125            // Fan animation step (8 fps)
+static uint32_t display_fan_last_time = 0;
+static uint8_t display_fan_phase = 0;
+
+/* Fan spinner frames (|, /, -, \), rewritten in place in one CGRAM slot */
+static const uint8_t display_fan_frames[4][8] = {
+  { 0x00, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x00 },
+  { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00, 0x00 },
+  { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00, 0x00 },
+  { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, 0x00 },
+};
+
+/* ========== Configured Sensors ========== */
+extern I2C_HandleTypeDef hi2c1;
+#if SENSOR_USE_LM75
+static LM75_t lm75 = { &hi2c1, LM75_ADDR_DEFAULT, SENSOR_HEALTH_ABSENT };
+#endif
+#if SENSOR_USE_SHT3X
+static SHT3x_t sht3x = { &hi2c1, SHT3X_ADDR_DEFAULT, 0, 0, SENSOR_HEALTH_ABSENT };
+#endif
+
+/* Priority order: the first healthy sensor drives currentTemp */
+static Sensor_t sensor_table[] = {
+  /*           driver              context  period  timeout                 oversample (2^n) */
+  SENSOR_ENTRY(&DS18B20_SensorOps, NULL, 500, DS18B20_CONV_TIMEOUT_MS, 2),  /* 1/16 -> 1/32 degC every ~3 s */
+#if SENSOR_USE_LM75
+  SENSOR_ENTRY(&LM75_SensorOps, &lm75, 500, 100, 4),  /* 0.5 degC LSB -> 1/8 degC every 8 s */
+#endif
+#if SENSOR_USE_SHT3X
+  SENSOR_ENTRY(&SHT3x_SensorOps, &sht3x, 500, 100, 0),
+#endif
+};
+#define SENSOR_TABLE_SIZE (sizeof(sensor_table) / sizeof(sensor_table[0]))
+static uint8_t sensor_primary = 0xFF;       // Index driving currentTemp, 0xFF = none
+#define SENSOR_POLL_PERIOD 10               // ms between ready polls
+
 /* ========== Debounce Variables ========== */
 static uint8_t button_press_count[4] = {0};  // Debounce counters for 4 buttons
 static uint8_t button_state[4] = {0};        // Current state of 4 buttons
 #define DEBOUNCE_COUNT 3                    // Number of checks to confirm button press
 
+/* Sensor calibration: in SETTING mode hold UP + DOWN for 3 s with the sensor
+   at a known temperature equal to setTemp (e.g. next to a reference thermometer) */
+#define CALIB_HOLD_COUNT 60                 // Task_Input cycles (50ms) both arrows held
+static uint8_t calib_hold_count = 0;
+static int8_t arrow_base_setTemp = 28;      // setTemp before the first arrow of a press pair
+
 /* ========== Forward Declarations ========== */
 static void Button_Debounce(void);
 static void Handle_Button_Press(uint8_t button_id);
+static void Display_Sparkline(char *out);
 
 /**
- * @brief Task_Sensor - Read temperature from DS18B20 sensor
- * Runs every 500ms at Normal priority
+ * @brief Task_Sensor - Drive every configured sensor without blocking
+ * Polls every 10ms; each sensor starts a conversion every 500ms and is
+ * read as soon as its driver reports ready (DS18B20 ~750ms, I2C 10-20ms)
  */
 void Task_Sensor(void)
 {
   uint32_t current_time = HAL_GetTick();
   
-  if ((current_time - task_sensor_last_time) >= 500)
+  if ((current_time - task_sensor_last_time) >= SENSOR_POLL_PERIOD)
   {
     task_sensor_last_time = current_time;
     
-    /* Start temperature conversion */
-    DS18B20_Start();
-    DS18B20_Write(0xCC);  // Skip ROM command
-    DS18B20_Write(0x44);  // Convert T command
+    /* DS18B20 alarm band: setpoint +/- margin, in-band sensors are read less often */
+    DS18B20_SetAlarmBand((int8_t)(thermostat_state.setTemp - DS18B20_ALARM_MARGIN),
+                         (int8_t)(thermostat_state.setTemp + DS18B20_ALARM_MARGIN));
     
-    /* Wait for conversion (9-bit: ~187.5ms, 10-bit: ~375ms, 12-bit: 750ms) */
-    HAL_Delay(400);  // Conservative delay for 12-bit
+    uint8_t fresh = 0;  /* Bit i set: sensor i has a new reading */
+    for (uint8_t i = 0; i < SENSOR_TABLE_SIZE; i++)
+    {
+      if (Sensor_Poll(&sensor_table[i], current_time))
+      {
+        fresh |= (uint8_t)(1U << i);
+      }
+    }
     
-    /* Read temperature value */
-    float temp = DS18B20_GetTemp();
+    uint8_t primary = 0xFF;
+    for (uint8_t i = 0; i < SENSOR_TABLE_SIZE && primary == 0xFF; i++)
+    {
+      if (sensor_table[i].valid && Sensor_Health(&sensor_table[i]) == SENSOR_HEALTH_OK)
+      {
+        primary = i;  /* First healthy sensor drives control */
+      }
+    }
     
-    /* Update global state */
-    thermostat_state.currentTemp = temp;
+    if (primary != sensor_primary)
+    {
+      /* Different sensor (or none): don't blend its history into the new one */
+      TempFilter_Init(&sensor_filter);
+      TempTrend_Init(&sensor_trend);
+      TempHistory_Init(&sensor_history);
+      thermostat_state.trend = 0;
+      sensor_primary = primary;
+    }
+    thermostat_state.sensorOk = (primary != 0xFF);
+    if (primary != 0xFF)
+    {
+      /* Show only the decimals the (oversampled) reading actually resolves */
+      thermostat_state.tempDigits = (Sensor_ResolutionBits(&sensor_table[primary]) >= 5) ? 2 : 1;
+    }
+    
+    if (primary != 0xFF && (fresh & (1U << primary)))
+    {
+      /* Filter, then update global state only with validated data */
+      TempSample_t sample;
+      sample.value = sensor_table[primary].temp;
+      sample.timestamp = current_time;
+      sample = TempFilter_Update(&sensor_filter, sample);
+      thermostat_state.currentTemp = sample.value;
+      TempTrend_Update(&sensor_trend, sample);
+      thermostat_state.trend = TempTrend_Slope(&sensor_trend);
+      TempHistory_Update(&sensor_history, sample);
+    }
   }
 }
 
@@ -74,6 +173,10 @@ void Task_Input(void)
  * Hysteresis logic:
  *   - Turn ON if currentTemp >= setTemp
  *   - Turn OFF if currentTemp <= setTemp - 1.0
+ *   - Feed-forward (TEMP_TREND_FEEDFORWARD): also turn ON when the
+ *     temperature extrapolated TEMP_TREND_HORIZON_S ahead reaches setTemp
+ * All comparisons are done on Q8.8 integers (Temp_t)
+ * Without a healthy sensor the fan keeps its current state
  */
 void Task_Control(void)
 {
@@ -84,21 +187,30 @@ void Task_Control(void)
     task_control_last_time = current_time;
     
     /* Only control fan if system is in NORMAL mode */
-    if (thermostat_state.mode == 1)  // NORMAL mode
+    if (thermostat_state.mode == 1 && thermostat_state.sensorOk)  // NORMAL mode
     {
-      float current = thermostat_state.currentTemp;
-      float setpoint = thermostat_state.setTemp;
+      Temp_t current = thermostat_state.currentTemp;
+      Temp_t setpoint = TEMP_FROM_INT(thermostat_state.setTemp);
+      Temp_t predicted = current;
+      
+#if TEMP_TREND_FEEDFORWARD
+      /* Rising temperature: act before the sensor lag lets it overshoot */
+      if (thermostat_state.trend > 0)
+      {
+        predicted = TempTrend_Predict(&sensor_trend, current, TEMP_TREND_HORIZON_S);
+      }
+#endif
       
       /* Hysteresis control logic */
-      if (current >= setpoint && !thermostat_state.isFanOn)
+      if ((current >= setpoint || predicted >= setpoint) && !thermostat_state.isFanOn)
       {
-        /* Turn ON fan when temp >= setpoint */
+        /* Turn ON fan when temp (or predicted temp) >= setpoint */
         thermostat_state.isFanOn = 1;
         HAL_GPIO_WritePin(Fan_in_GPIO_Port, Fan_in_Pin, GPIO_PIN_SET);
       }
-      else if (current <= (setpoint - 1.0f) && thermostat_state.isFanOn)
+      else if (current <= (setpoint - TEMP_ONE) && predicted < setpoint && thermostat_state.isFanOn)
       {
-        /* Turn OFF fan when temp <= setpoint - 1.0°C */
+        /* Turn OFF fan when temp <= setpoint - 1.0°C and no longer heading up to it */
         thermostat_state.isFanOn = 0;
         HAL_GPIO_WritePin(Fan_in_GPIO_Port, Fan_in_Pin, GPIO_PIN_RESET);
       }
@@ -119,37 +231,165 @@ void Task_Control(void)
 void Task_Display(void)
 {
   uint32_t current_time = HAL_GetTick();
-  char buffer[17];  // 16 chars + null terminator
+  char buffer[LCD_FB_COLS + 1];
+  char *p;
+  
+  /* Fan animation: only the glyph's CGRAM bytes change, the cell showing it
+     is untouched, so each step is a single 55-byte I2C burst */
+  if (thermostat_state.isFanOn && (current_time - display_fan_last_time) >= DISPLAY_FAN_FRAME_MS)
+  {
+    display_fan_last_time = current_time;
+    display_fan_phase = (display_fan_phase + 1) % 4;
+    lcdGlyph(LCD_ICON_FAN, display_fan_frames[display_fan_phase]);
+    lcdFlushAsync();  /* Busy: the dirty slot rides along with the next flush */
+  }
   
   if ((current_time - task_display_last_time) >= 200)
   {
     task_display_last_time = current_time;
+    uint32_t fmt_start, fmt_cycles;
     
-    /* Line 0: Display current temperature */
-    lcdSetCursor(0, 0);
-    sprintf(buffer, "T:%.2f C S:%d",
-            thermostat_state.currentTemp, 
-            thermostat_state.setTemp);
-    lcdWriteString(buffer);
+    /* Line 0: current temperature (Q8.8 -> tempDigits decimals, rounded),
+       right-aligned in a fixed field so the text never shifts: "T:-55.00 C S:28" */
+    uint8_t digits = (thermostat_state.tempDigits == 2) ? 2 : 1;
+    uint8_t width = digits + 4;  /* sign, 2 integer digits, point */
     
-    /* Line 1: Display mode and fan status */
-    lcdSetCursor(1, 0);
+    /* Render the whole frame into the shadow buffer, flush sends only changes */
+    lcdFbClear();
+    fmt_start = DWT->CYCCNT;  /* Only the FixFmt_* calls are timed */
+    p = FixFmt_Str(buffer, "T:", 0);
+    if (thermostat_state.sensorOk)
+    {
+      p = FixFmt_Q(p, thermostat_state.currentTemp, TEMP_FRAC_BITS, digits, width);
+    }
+    else
+    {
+      /* No healthy sensor: don't show a stale value */
+      p = FixFmt_Str(p, (digits == 2) ? "--.--" : "--.-", width);
+    }
+    p = FixFmt_Str(p, " C S:", 0);
+    FixFmt_Int(p, thermostat_state.setTemp, 2);
+    fmt_cycles = DWT->CYCCNT - fmt_start;
+    lcdFbWrite(0, 0, buffer);
+    
+    /* Trend arrow in the last column (CGRAM glyph, cached) */
+    if (thermostat_state.sensorOk && thermostat_state.trend >= DISPLAY_TREND_ARROW)
+      buffer[0] = lcdIcon(LCD_ICON_ARROW_UP);
+    else if (thermostat_state.sensorOk && thermostat_state.trend <= -DISPLAY_TREND_ARROW)
+      buffer[0] = lcdIcon(LCD_ICON_ARROW_DOWN);
+    else
+      buffer[0] = ' ';
+    buffer[1] = '\0';
+    lcdFbWrite(0, LCD_FB_COLS - 1, buffer);
     
+    /* Line 1: Display mode and fan status */
     const char *mode_str;
     if (thermostat_state.mode == 0)
       mode_str = "OFF";
     else if (thermostat_state.mode == 1)
-      mode_str = "NORMAL";
+      mode_str = DISPLAY_SPARKLINE ? "NORM" : "NORMAL";
     else
-      mode_str = "SETTING";
+      mode_str = DISPLAY_SPARKLINE ? "SET" : "SETTING";
+    
+    const char *fan_str = thermostat_state.isFanOn ? "ON" : "OFF";
+    
+    fmt_start = DWT->CYCCNT;
+    p = FixFmt_Str(buffer, "M:", 0);
+    p = FixFmt_Str(p, mode_str, 0);
+    p = FixFmt_Str(p, " F:", 0);
+    p = FixFmt_Str(p, fan_str, 0);
+    fmt_cycles += DWT->CYCCNT - fmt_start;
+    display_fmt_cycles = fmt_cycles;
+    if (thermostat_state.isFanOn)
+    {
+      /* Spinning fan after "ON" (same slot as the animation above) */
+      *p++ = lcdGlyph(LCD_ICON_FAN, display_fan_frames[display_fan_phase]);
+      *p = '\0';
+    }
+    lcdFbWrite(1, 0, buffer);
     
-    const char *fan_str = thermostat_state.isFanOn ? "ON " : "OFF";
+#if DISPLAY_SPARKLINE
+    Display_Sparkline(buffer);
+    lcdFbWrite(1, LCD_FB_COLS - DISPLAY_SPARK_CELLS, buffer);
+#endif
     
-    sprintf(buffer, "M:%s F:%s    ", mode_str, fan_str);
-    lcdWriteString(buffer);
+    display_wire_bytes = lcdFlushAsync();
   }
 }
 
+/**
+ * @brief I2C bytes queued by the last display frame
+ * @retval 0 when nothing changed or the previous frame was still on the wire
+ */
+uint16_t Task_Display_GetWireBytes(void)
+{
+  return display_wire_bytes;
+}
+
+/**
+ * @brief DWT cycles spent in the FixFmt_* calls of the last display frame
+ * @note  Excludes framebuffer writes and glyph lookups (compare with sprintf)
+ */
+uint32_t Task_Display_GetFmtCycles(void)
+{
+  return display_fmt_cycles;
+}
+
+/**
+ * @brief Render the history ring as DISPLAY_SPARK_CELLS bar glyphs
+ * @param out: Receives the glyph codes, NUL-terminated
+ * @note  Newest entry is the rightmost column; the vertical scale spans the
+ *        window's min..max (at least DISPLAY_SPARK_MIN_SPAN). Glyphs go
+ *        through the LCD glyph cache, so only cells whose bars changed are
+ *        re-uploaded to CGRAM.
+ */
+static void Display_Sparkline(char *out)
+{
+  uint8_t n = sensor_history.count;
+  uint8_t cell, j;
+  
+  if (n == 0)
+  {
+    memset(out, ' ', DISPLAY_SPARK_CELLS);
+    out[DISPLAY_SPARK_CELLS] = '\0';
+    return;
+  }
+  
+  Temp_t lo = TempHistory_Get(&sensor_history, 0);
+  Temp_t hi = lo;
+  for (uint8_t i = 1; i < n; i++)
+  {
+    Temp_t t = TempHistory_Get(&sensor_history, i);
+    if (t < lo) lo = t;
+    if (t > hi) hi = t;
+  }
+  int32_t span = (int32_t)hi - lo;
+  int32_t base = lo;
+  if (span < DISPLAY_SPARK_MIN_SPAN)
+  {
+    base -= (DISPLAY_SPARK_MIN_SPAN - span) / 2;  /* Keep a flat line mid-height */
+    span = DISPLAY_SPARK_MIN_SPAN;
+  }
+  
+  for (cell = 0; cell < DISPLAY_SPARK_CELLS; cell++)
+  {
+    uint8_t bitmap[8] = {0};
+    for (j = 0; j < 4; j++)
+    {
+      int16_t idx = (int16_t)(cell * 4 + j) - (TEMP_HISTORY_LEN - n);
+      if (idx < 0)
+        continue;  /* Not enough history yet: column stays empty */
+      int32_t level = 1 + ((int32_t)TempHistory_Get(&sensor_history, (uint8_t)idx) - base) * 7 / span;
+      if (level > 8)
+        level = 8;
+      for (uint8_t row = 8 - level; row < 8; row++)
+        bitmap[row] |= 0x10 >> j;
+    }
+    out[cell] = lcdGlyph(LCD_GLYPH_USER + cell, bitmap);
+  }
+  out[DISPLAY_SPARK_CELLS] = '\0';
+}
+
 /**
  * @brief Button debounce handler
  * Polls all 4 buttons and updates their states with debouncing
@@ -187,6 +427,19 @@ static void Button_Debounce(void)
       button_state[i] = 0;
     }
   }
+  
+  /* UP + DOWN held in SETTING mode: calibrate the primary sensor to setTemp */
+  if (thermostat_state.mode == 2 && button_state[0] && button_state[1])
+  {
+    if (calib_hold_count < CALIB_HOLD_COUNT && ++calib_hold_count == CALIB_HOLD_COUNT)
+    {
+      DS18B20_CalibratePrimary(TEMP_FROM_INT(thermostat_state.setTemp));
+    }
+  }
+  else
+  {
+    calib_hold_count = 0;
+  }
 }
 
 /**
@@ -198,20 +451,46 @@ static void Handle_Button_Press(uint8_t button_id)
   switch (button_id)
   {
     case 0:  /* UP button (PA2) - Increase setTemp */
-      if (thermostat_state.mode == 2 && thermostat_state.setTemp < 50)
+      if (thermostat_state.mode == 2 && button_state[1])
+      {
+        /* DOWN already held: start of a calibration hold, undo its step */
+        if (thermostat_state.setTemp != arrow_base_setTemp)
+        {
+          thermostat_state.setTemp = arrow_base_setTemp;
+          EEPROM_SaveSetpoint(thermostat_state.setTemp);
+        }
+      }
+      else if (thermostat_state.mode == 2)
       {
-        thermostat_state.setTemp++;
-        /* Save to EEPROM */
-        EEPROM_SaveSetpoint(thermostat_state.setTemp);
+        arrow_base_setTemp = thermostat_state.setTemp;
+        if (thermostat_state.setTemp < 50)
+        {
+          thermostat_state.setTemp++;
+          /* Save to EEPROM */
+          EEPROM_SaveSetpoint(thermostat_state.setTemp);
+        }
       }
       break;
       
     case 1:  /* DOWN button (PA3) - Decrease setTemp */
-      if (thermostat_state.mode == 2 && thermostat_state.setTemp > 10)
+      if (thermostat_state.mode == 2 && button_state[0])
       {
-        thermostat_state.setTemp--;
-        /* Save to EEPROM */
-        EEPROM_SaveSetpoint(thermostat_state.setTemp);
+        /* UP already held: start of a calibration hold, undo its step */
+        if (thermostat_state.setTemp != arrow_base_setTemp)
+        {
+          thermostat_state.setTemp = arrow_base_setTemp;
+          EEPROM_SaveSetpoint(thermostat_state.setTemp);
+        }
+      }
+      else if (thermostat_state.mode == 2)
+      {
+        arrow_base_setTemp = thermostat_state.setTemp;
+        if (thermostat_state.setTemp > 10)
+        {
+          thermostat_state.setTemp--;
+          /* Save to EEPROM */
+          EEPROM_SaveSetpoint(thermostat_state.setTemp);
+        }
       }
       break;
       
@@ -250,6 +529,12 @@ void Task_Scheduler_Init(void)
   task_input_last_time = current_time;
   task_control_last_time = current_time;
   task_display_last_time = current_time;
+  TempFilter_Init(&sensor_filter);
+  TempHistory_Init(&sensor_history);
+  for (uint8_t i = 0; i < SENSOR_TABLE_SIZE; i++)
+  {
+    Sensor_Init(&sensor_table[i], current_time);
+  }
 }
 
 /**
@@ -261,6 +546,6 @@ void Task_Scheduler_Run(void)
 {
   Task_Input();      // 50ms - HIGH priority
   Task_Control();    // 100ms - HIGH priority
-  Task_Sensor();     // 500ms - NORMAL priority
+  Task_Sensor();     // 10ms poll - NORMAL priority
   Task_Display();    // 200ms - LOW priority
 }
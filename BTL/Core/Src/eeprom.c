@@ -9,11 +9,24 @@
 
 #include "eeprom.h"
 #include "stm32f1xx_hal.h"
+#include <stddef.h>
+#include <string.h>
+
+/* CRC covers everything before the crc member (no trailing padding) */
+#define EEPROM_CRC_LENGTH    offsetof(EEPROMData_t, crc)
+
+/* Version 1 layout: magic, setTemp, crc at offset 6 over the first 6 bytes */
+typedef struct {
+    uint32_t magic;
+    int8_t setTemp;
+    uint16_t crc;
+} EEPROMDataV1_t;
 
 /* ========== EEPROM Data Structure ========== */
 static EEPROMData_t eeprom_data = {
     .magic = 0xDEADBEEF,
     .setTemp = 28,
+    .version = EEPROM_VERSION,
     .crc = 0
 };
 
@@ -115,6 +128,55 @@ static HAL_StatusTypeDef EEPROM_WriteFlash(uint32_t address, const uint8_t *data
     return HAL_OK;
 }
 
+/* ========== RAM Buffer Helpers ========== */
+/**
+ * @brief Reset RAM buffer to defaults (empty calibration table)
+ * @param setTemp: Setpoint to store
+ */
+static void EEPROM_SetDefaults(int8_t setTemp)
+{
+    memset(&eeprom_data, 0xFF, sizeof(eeprom_data));
+    eeprom_data.magic = 0xDEADBEEF;
+    eeprom_data.setTemp = setTemp;
+    eeprom_data.version = EEPROM_VERSION;
+    eeprom_data.crc = EEPROM_CRC16((const uint8_t *)&eeprom_data, EEPROM_CRC_LENGTH);
+}
+
+/**
+ * @brief Validate an image in flash (magic, version, CRC)
+ * @param flash_data: Pointer to the flash image
+ * @retval 1 if valid, 0 otherwise
+ */
+static uint8_t EEPROM_IsValid(const EEPROMData_t *flash_data)
+{
+    if (flash_data->magic != 0xDEADBEEF || flash_data->version != EEPROM_VERSION)
+    {
+        return 0;
+    }
+    return EEPROM_CRC16((const uint8_t *)flash_data, EEPROM_CRC_LENGTH) == flash_data->crc;
+}
+
+/**
+ * @brief Recompute CRC of the RAM buffer, erase the page and write it
+ * @retval HAL_OK if successful, HAL_ERROR otherwise
+ */
+static HAL_StatusTypeDef EEPROM_Commit(void)
+{
+    eeprom_data.magic = 0xDEADBEEF;
+    eeprom_data.version = EEPROM_VERSION;
+    eeprom_data.crc = EEPROM_CRC16((const uint8_t *)&eeprom_data, EEPROM_CRC_LENGTH);
+    
+    /* Erase the flash page */
+    if (EEPROM_ErasePage() != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+    
+    /* Write the new data */
+    return EEPROM_WriteFlash(EEPROM_START_ADDR, (const uint8_t *)&eeprom_data, 
+                             sizeof(EEPROMData_t));
+}
+
 /* ========== Public Functions ========== */
 
 /**
@@ -124,39 +186,28 @@ static HAL_StatusTypeDef EEPROM_WriteFlash(uint32_t address, const uint8_t *data
 HAL_StatusTypeDef EEPROM_Init(void)
 {
     /* Read EEPROM data from flash */
-    EEPROMData_t *flash_data = (EEPROMData_t *)EEPROM_START_ADDR;
+    const EEPROMData_t *flash_data = (const EEPROMData_t *)EEPROM_START_ADDR;
+    const EEPROMDataV1_t *flash_v1 = (const EEPROMDataV1_t *)EEPROM_START_ADDR;
     
-    /* Verify magic number */
-    if (flash_data->magic != 0xDEADBEEF)
+    if (EEPROM_IsValid(flash_data))
     {
-        /* No valid data in EEPROM, use defaults */
-        eeprom_data.magic = 0xDEADBEEF;
-        eeprom_data.setTemp = 28;
-        eeprom_data.crc = EEPROM_CRC16((const uint8_t *)&eeprom_data, 
-                                        sizeof(eeprom_data) - sizeof(uint16_t));
-        return HAL_ERROR;  /* Data not valid, using defaults */
+        /* Valid data found, copy to RAM buffer */
+        memcpy(&eeprom_data, flash_data, sizeof(eeprom_data));
+        return HAL_OK;
     }
     
-    /* Verify data integrity with CRC */
-    uint16_t calculated_crc = EEPROM_CRC16((const uint8_t *)flash_data, 
-                                            sizeof(EEPROMData_t) - sizeof(uint16_t));
-    
-    if (calculated_crc != flash_data->crc)
+    /* Version 1 image: keep the setpoint, start with an empty calibration table */
+    if (flash_v1->magic == 0xDEADBEEF &&
+        EEPROM_CRC16((const uint8_t *)flash_v1, offsetof(EEPROMDataV1_t, crc)) == flash_v1->crc &&
+        flash_v1->setTemp >= 10 && flash_v1->setTemp <= 50)
     {
-        /* CRC mismatch, data is corrupted */
-        eeprom_data.magic = 0xDEADBEEF;
-        eeprom_data.setTemp = 28;
-        eeprom_data.crc = EEPROM_CRC16((const uint8_t *)&eeprom_data, 
-                                        sizeof(eeprom_data) - sizeof(uint16_t));
-        return HAL_ERROR;
+        EEPROM_SetDefaults(flash_v1->setTemp);
+        return EEPROM_Commit();
     }
     
-    /* Valid data found, copy to RAM buffer */
-    eeprom_data.magic = flash_data->magic;
-    eeprom_data.setTemp = flash_data->setTemp;
-    eeprom_data.crc = flash_data->crc;
-    
-    return HAL_OK;
+    /* No valid data in EEPROM (empty or corrupted), use defaults */
+    EEPROM_SetDefaults(28);
+    return HAL_ERROR;  /* Data not valid, using defaults */
 }
 
 /**
@@ -172,21 +223,9 @@ HAL_StatusTypeDef EEPROM_SaveSetpoint(int8_t setTemp)
         return HAL_ERROR;
     }
     
-    /* Update RAM buffer */
-    eeprom_data.magic = 0xDEADBEEF;
+    /* Update RAM buffer (calibration table is kept) and write it */
     eeprom_data.setTemp = setTemp;
-    eeprom_data.crc = EEPROM_CRC16((const uint8_t *)&eeprom_data, 
-                                    sizeof(eeprom_data) - sizeof(uint16_t));
-    
-    /* Erase the flash page */
-    if (EEPROM_ErasePage() != HAL_OK)
-    {
-        return HAL_ERROR;
-    }
-    
-    /* Write the new data */
-    return EEPROM_WriteFlash(EEPROM_START_ADDR, (const uint8_t *)&eeprom_data, 
-                             sizeof(EEPROMData_t));
+    return EEPROM_Commit();
 }
 
 /**
@@ -202,19 +241,10 @@ HAL_StatusTypeDef EEPROM_LoadSetpoint(int8_t *pSetTemp)
     }
     
     /* Read from flash */
-    EEPROMData_t *flash_data = (EEPROMData_t *)EEPROM_START_ADDR;
+    const EEPROMData_t *flash_data = (const EEPROMData_t *)EEPROM_START_ADDR;
     
-    /* Verify magic number */
-    if (flash_data->magic != 0xDEADBEEF)
-    {
-        return HAL_ERROR;
-    }
-    
-    /* Verify CRC */
-    uint16_t calculated_crc = EEPROM_CRC16((const uint8_t *)flash_data, 
-                                            sizeof(EEPROMData_t) - sizeof(uint16_t));
-    
-    if (calculated_crc != flash_data->crc)
+    /* Verify magic number, layout version and CRC */
+    if (!EEPROM_IsValid(flash_data))
     {
         return HAL_ERROR;
     }
@@ -242,19 +272,80 @@ HAL_StatusTypeDef EEPROM_Erase(int8_t defaultSetTemp)
         return HAL_ERROR;
     }
     
-    /* Update RAM buffer with defaults */
-    eeprom_data.magic = 0xDEADBEEF;
-    eeprom_data.setTemp = defaultSetTemp;
-    eeprom_data.crc = EEPROM_CRC16((const uint8_t *)&eeprom_data, 
-                                    sizeof(eeprom_data) - sizeof(uint16_t));
+    /* Update RAM buffer with defaults (clears calibration table) */
+    EEPROM_SetDefaults(defaultSetTemp);
+    return EEPROM_Commit();
+}
+
+/**
+ * @brief Look up calibration coefficients for a sensor
+ * @param rom: 64-bit ROM code of the sensor
+ * @param pOffset: Pointer to store offset (Q8.8 degC)
+ * @param pGain: Pointer to store gain (Q2.14)
+ * @retval HAL_OK if an entry exists, HAL_ERROR otherwise (outputs = identity)
+ */
+HAL_StatusTypeDef EEPROM_LoadCalibration(const uint8_t *rom, int16_t *pOffset, int16_t *pGain)
+{
+    if (rom == NULL || pOffset == NULL || pGain == NULL)
+    {
+        return HAL_ERROR;
+    }
     
-    /* Erase the flash page */
-    if (EEPROM_ErasePage() != HAL_OK)
+    /* Default: no correction */
+    *pOffset = 0;
+    *pGain = EEPROM_CALIB_GAIN_ONE;
+    
+    for (uint8_t i = 0; i < EEPROM_MAX_CALIB; i++)
+    {
+        if (memcmp(eeprom_data.calib[i].rom, rom, 8) == 0)
+        {
+            *pOffset = eeprom_data.calib[i].offset;
+            *pGain = eeprom_data.calib[i].gain;
+            return HAL_OK;
+        }
+    }
+    return HAL_ERROR;
+}
+
+/**
+ * @brief Store calibration coefficients for a sensor (replaces existing entry)
+ * @param rom: 64-bit ROM code of the sensor
+ * @param offset: Offset in Q8.8 degC
+ * @param gain: Gain in Q2.14
+ * @retval HAL_OK if successful, HAL_ERROR if the table is full or flash fails
+ */
+HAL_StatusTypeDef EEPROM_SaveCalibration(const uint8_t *rom, int16_t offset, int16_t gain)
+{
+    static const uint8_t free_rom[8] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    EEPROMCalib_t *entry = NULL;
+    
+    if (rom == NULL || gain <= 0)
     {
         return HAL_ERROR;
     }
     
-    /* Write default data */
-    return EEPROM_WriteFlash(EEPROM_START_ADDR, (const uint8_t *)&eeprom_data, 
-                             sizeof(EEPROMData_t));
+    /* Existing entry for this ROM first, otherwise the first free entry */
+    for (uint8_t i = 0; i < EEPROM_MAX_CALIB && entry == NULL; i++)
+    {
+        if (memcmp(eeprom_data.calib[i].rom, rom, 8) == 0)
+        {
+            entry = &eeprom_data.calib[i];
+        }
+    }
+    for (uint8_t i = 0; i < EEPROM_MAX_CALIB && entry == NULL; i++)
+    {
+        if (memcmp(eeprom_data.calib[i].rom, free_rom, 8) == 0)
+        {
+            entry = &eeprom_data.calib[i];
+        }
+    }
+    if (entry == NULL)
+    {
+        return HAL_ERROR;  /* Table full */
+    }
+    
+    memcpy(entry->rom, rom, 8);
+    entry->offset = offset;
+    entry->gain = gain;
+    return EEPROM_Commit();
 }
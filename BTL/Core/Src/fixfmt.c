@@ -0,0 +1,147 @@
+/**
+  ******************************************************************************
+  * @file    fixfmt.c
+  * @brief   Fixed-point to decimal formatting without printf
+  * @details The magnitude is split into integer and fractional bits; the
+  *          fraction is scaled to the requested decimals with one multiply
+  *          and a shift (no division by a variable, no 64-bit math), and
+  *          digits are peeled off with constant divisions by 10, which the
+  *          compiler turns into multiplies.
+  ******************************************************************************
+  */
+
+#include "fixfmt.h"
+
+static const uint16_t decPow10[FIXFMT_MAX_DECIMALS + 1] = { 1, 10, 100, 1000, 10000 };
+
+/* ========== Private Functions ========== */
+
+/**
+ * @brief Emit len characters held in reverse order, padded to width
+ */
+static char *FixFmt_Emit(char *dst, const char *rev, uint8_t len, uint8_t width)
+{
+    if (width != 0 && len > width)
+    {
+        while (width--)
+        {
+            *dst++ = FIXFMT_OVERFLOW_CHAR;
+        }
+    }
+    else
+    {
+        for (; width > len; width--)
+        {
+            *dst++ = ' ';
+        }
+        while (len)
+        {
+            *dst++ = rev[--len];
+        }
+    }
+    *dst = '\0';
+    return dst;
+}
+
+/* ========== Public Functions ========== */
+
+/**
+ * @brief Format a signed fixed-point value
+ * @param dst: Output buffer (at least max(width, 16) + 1 bytes)
+ * @param value: Fixed-point value with fracBits fractional bits
+ * @param fracBits: Fractional bits in value (0..FIXFMT_MAX_FRAC_BITS, 0 = integer)
+ * @param decimals: Digits after the point (0..FIXFMT_MAX_DECIMALS), rounded
+ *                  half away from zero
+ * @param width: Field width, right-aligned with spaces; 0 = no padding
+ * @retval Pointer to the terminating NUL
+ */
+char *FixFmt_Q(char *dst, int32_t value, uint8_t fracBits, uint8_t decimals, uint8_t width)
+{
+    char rev[16];   /* '-' + 10 integer digits + '.' + 4 decimals, reversed */
+    uint8_t len = 0;
+    uint8_t neg = (value < 0);
+    uint32_t mag = neg ? (uint32_t)0 - (uint32_t)value : (uint32_t)value;
+    uint32_t ipart, fpart;
+
+    if (fracBits > FIXFMT_MAX_FRAC_BITS)
+    {
+        fracBits = FIXFMT_MAX_FRAC_BITS;
+    }
+    if (decimals > FIXFMT_MAX_DECIMALS)
+    {
+        decimals = FIXFMT_MAX_DECIMALS;
+    }
+
+    /* Round the fraction to 'decimals' digits; a carry moves into ipart */
+    ipart = mag >> fracBits;
+    fpart = ((mag & ((1UL << fracBits) - 1)) * decPow10[decimals] + ((1UL << fracBits) >> 1)) >> fracBits;
+    if (fpart >= decPow10[decimals])
+    {
+        fpart -= decPow10[decimals];
+        ipart++;
+    }
+    if (ipart == 0 && fpart == 0)
+    {
+        neg = 0;    /* No "-0.0" */
+    }
+
+    for (uint8_t i = 0; i < decimals; i++)
+    {
+        rev[len++] = (char)('0' + fpart % 10);
+        fpart /= 10;
+    }
+    if (decimals)
+    {
+        rev[len++] = '.';
+    }
+    do
+    {
+        rev[len++] = (char)('0' + ipart % 10);
+        ipart /= 10;
+    } while (ipart);
+    if (neg)
+    {
+        rev[len++] = '-';
+    }
+
+    return FixFmt_Emit(dst, rev, len, width);
+}
+
+/**
+ * @brief Format a signed integer, right-aligned in width (0 = no padding)
+ * @param dst: Output buffer
+ * @param value: Integer to print
+ * @param width: Field width; a wider value is shown as overflow chars
+ * @retval Pointer to the terminating NUL
+ */
+char *FixFmt_Int(char *dst, int32_t value, uint8_t width)
+{
+    return FixFmt_Q(dst, value, 0, 0, width);
+}
+
+/**
+ * @brief Copy a string, right-aligned in width (0 = no padding)
+ * @param dst: Output buffer
+ * @param str: NUL-terminated text, copied whole even if wider than width
+ * @param width: Field width
+ * @retval Pointer to the terminating NUL
+ */
+char *FixFmt_Str(char *dst, const char *str, uint8_t width)
+{
+    uint8_t len = 0;
+
+    while (str[len])
+    {
+        len++;
+    }
+    for (; width > len; width--)
+    {
+        *dst++ = ' ';
+    }
+    while (*str)
+    {
+        *dst++ = *str++;
+    }
+    *dst = '\0';
+    return dst;
+}
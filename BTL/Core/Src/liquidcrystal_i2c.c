@@ -1,4 +1,5 @@
 #include "liquidcrystal_i2c.h"
+#include <string.h>
 
 extern I2C_HandleTypeDef hi2c1;
 
@@ -8,12 +9,58 @@ uint8_t dpMode;
 uint8_t dpRows;
 uint8_t dpBacklight;
 
+/* Bytes on the I2C wire (address + data) since reset */
+static uint32_t wireBytes;
+
+/* Packed expander stream, sent as one I2C transaction */
+static uint8_t txBuf[LCD_TX_BUF_SIZE];
+static uint16_t txLen;
+static uint8_t txBatch;   /* >0: Send() only queues, TxEnd() transmits */
+static uint8_t txAsync;   /* TxFlush() hands txBuf to DMA instead of blocking */
+static volatile uint8_t txBusy;  /* DMA owns txBuf until the completion callback */
+
+/* Cleared at init on RW-strapped modules, or when busy-flag read-back fails;
+   fixed delays are used from then on */
+static uint8_t busyFlagOk = LCD_BUSY_POLL;
+
+/* Shadow framebuffer: fbShadow is rendered into, fbPanel mirrors the LCD */
+static uint8_t fbShadow[LCD_FB_ROWS][LCD_FB_COLS];
+static uint8_t fbPanel[LCD_FB_ROWS][LCD_FB_COLS];
+static uint8_t fbPanelValid;
+
+/* CGRAM glyph cache: slot contents, LRU stamps and pending uploads */
+#define GLYPH_NONE 0xFF
+static uint8_t glyphId[LCD_GLYPH_SLOTS];
+static uint8_t glyphMap[LCD_GLYPH_SLOTS][8];
+static uint32_t glyphUse[LCD_GLYPH_SLOTS];  /* 0 = free */
+static uint32_t glyphClock;                 /* Last stamp handed out */
+static uint32_t glyphFrame;                 /* glyphClock at the last flush */
+static uint8_t glyphDirty;                  /* Slots to upload on the next flush */
+static volatile uint8_t glyphInFlight;      /* Slots uploaded by the DMA frame on the wire */
+
+static const uint8_t iconMap[LCD_ICON_COUNT][8] = {
+  { 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x00, 0x00 },  /* Fan */
+  { 0x0C, 0x12, 0x12, 0x0C, 0x00, 0x00, 0x00, 0x00 },  /* Degree */
+  { 0x04, 0x0E, 0x15, 0x04, 0x04, 0x04, 0x04, 0x00 },  /* Arrow up */
+  { 0x04, 0x04, 0x04, 0x04, 0x15, 0x0E, 0x04, 0x00 },  /* Arrow down */
+};
+
 static void SendCommand(uint8_t);
 static void SendChar(uint8_t);
 static void Send(uint8_t, uint8_t);
 static void Write4Bits(uint8_t);
 static void ExpanderWrite(uint8_t);
 static void PulseEnable(uint8_t);
+static void TxBegin(void);
+static void TxEnd(void);
+static void TxFlush(void);
+static void TxWaitIdle(void);
+static void TxDropped(void);
+static HAL_StatusTypeDef ReadBusyFlag(uint8_t *);
+static void ProbeBusyFlag(void);
+static void WaitReady(uint32_t);
+static void GlyphReset(void);
+static void GlyphUpload(void);
 static void DelayInit(void);
 static void DelayUS(uint32_t);
 
@@ -56,6 +103,8 @@ void HD44780_Init(uint8_t rows)
     dpFunction |= LCD_5x10DOTS;
   }
 
+  GlyphReset();
+
   /* Wait for initialization */
   DelayInit();
   HAL_Delay(50);
@@ -78,6 +127,7 @@ void HD44780_Init(uint8_t rows)
 
   /* Display Control */
   SendCommand(LCD_FUNCTIONSET | dpFunction);
+  ProbeBusyFlag();
 
   dpControl = LCD_DISPLAYON | LCD_CURSOROFF | LCD_BLINKOFF;
   HD44780_Display();
@@ -86,7 +136,7 @@ void HD44780_Init(uint8_t rows)
   /* Display Mode */
   dpMode = LCD_ENTRYLEFT | LCD_ENTRYSHIFTDECREMENT;
   SendCommand(LCD_ENTRYMODESET | dpMode);
-  DelayUS(4500);
+  WaitReady(4500);
 
   HD44780_CreateSpecialChar(0, special1);
   HD44780_CreateSpecialChar(1, special2);
@@ -97,13 +147,15 @@ void HD44780_Init(uint8_t rows)
 void HD44780_Clear()
 {
   SendCommand(LCD_CLEARDISPLAY);
-  DelayUS(2000);
+  WaitReady(2000);
+  memset(fbPanel, ' ', sizeof(fbPanel));
+  fbPanelValid = 1;
 }
 
 void HD44780_Home()
 {
   SendCommand(LCD_RETURNHOME);
-  DelayUS(2000);
+  WaitReady(2000);
 }
 
 void HD44780_SetCursor(uint8_t col, uint8_t row)
@@ -189,11 +241,18 @@ void HD44780_NoAutoScroll(void)
 void HD44780_CreateSpecialChar(uint8_t location, uint8_t charmap[])
 {
   location &= 0x7;
+  /* Slot written behind the glyph cache's back: forget what it held */
+  glyphId[location] = GLYPH_NONE;
+  glyphUse[location] = 0;
+  glyphDirty &= ~(1 << location);
+  glyphInFlight &= ~(1 << location);
+  TxBegin();
   SendCommand(LCD_SETCGRAMADDR | (location << 3));
   for (int i=0; i<8; i++)
   {
     SendChar(charmap[i]);
   }
+  TxEnd();
 }
 
 void HD44780_PrintSpecialChar(uint8_t index)
@@ -208,7 +267,9 @@ void HD44780_LoadCustomCharacter(uint8_t char_num, uint8_t *rows)
 
 void HD44780_PrintStr(const char c[])
 {
+  TxBegin();
   while(*c) SendChar(*c++);
+  TxEnd();
 }
 
 void HD44780_SetBacklight(uint8_t new_val)
@@ -239,12 +300,184 @@ static void SendChar(uint8_t ch)
   Send(ch, RS);
 }
 
-static void Send(uint8_t value, uint8_t mode)
+/*
+ * Nibble encoder (runs from RAM): each nibble is queued as data, data|E,
+ * data so D4-D7/RS are set up before E rises and held after it falls.
+ * At 100 kHz one expander byte takes 90 us, which covers the E pulse width
+ * and the 37 us execution time of the previous byte without DelayUS.
+ */
+static __RAM_FUNC void Send(uint8_t value, uint8_t mode)
+{
+  uint8_t nib[2] = { (uint8_t)((value & 0xF0) | mode), (uint8_t)(((value << 4) & 0xF0) | mode) };
+
+  if (txBusy)
+  {
+    TxWaitIdle();
+  }
+  if (txLen + 6 > LCD_TX_BUF_SIZE)
+  {
+    TxFlush();
+  }
+  for (int i = 0; i < 2; i++)
+  {
+    txBuf[txLen++] = nib[i] | dpBacklight;
+    txBuf[txLen++] = nib[i] | ENABLE | dpBacklight;
+    txBuf[txLen++] = nib[i] | dpBacklight;
+  }
+  if (!txBatch)
+  {
+    TxFlush();
+  }
+}
+
+static void TxBegin(void)
 {
-  uint8_t highnib = value & 0xF0;
-  uint8_t lownib = (value<<4) & 0xF0;
-  Write4Bits((highnib)|mode);
-  Write4Bits((lownib)|mode);
+  txBatch++;
+}
+
+static void TxEnd(void)
+{
+  if (txBatch && --txBatch == 0)
+  {
+    TxFlush();
+  }
+}
+
+static void TxFlush(void)
+{
+  if (txLen == 0)
+  {
+    return;
+  }
+  TxWaitIdle();
+  if (txAsync)
+  {
+    txBusy = 1;
+    if (HAL_I2C_Master_Transmit_DMA(&hi2c1, DEVICE_ADDR, txBuf, txLen) != HAL_OK)
+    {
+      TxDropped();
+    }
+  }
+  else
+  {
+    /* Timeout: ~0.1 ms per byte at 100 kHz plus margin */
+    HAL_I2C_Master_Transmit(&hi2c1, DEVICE_ADDR, txBuf, txLen, 10 + txLen / 8);
+  }
+  wireBytes += txLen + 1;
+  txLen = 0;
+}
+
+/* Block until a DMA flush has released txBuf and the bus */
+static void TxWaitIdle(void)
+{
+  uint32_t start = HAL_GetTick();
+
+  while (txBusy)
+  {
+    if (HAL_GetTick() - start > LCD_TX_TIMEOUT_MS)
+    {
+      /* The abort finishes in the I2C IRQ: keep the bus until the HAL is
+         READY, or the next blocking transfer gets HAL_BUSY */
+      HAL_I2C_Master_Abort_IT(&hi2c1, DEVICE_ADDR);
+      start = HAL_GetTick();
+      while (HAL_I2C_GetState(&hi2c1) != HAL_I2C_STATE_READY &&
+             HAL_GetTick() - start <= LCD_ABORT_TIMEOUT_MS)
+      {
+      }
+      TxDropped();
+    }
+  }
+}
+
+/* Frame not (fully) delivered: redraw all text and re-send its glyphs */
+static void TxDropped(void)
+{
+  txBusy = 0;
+  fbPanelValid = 0;
+  glyphDirty |= glyphInFlight;
+  glyphInFlight = 0;
+}
+
+/*
+ * One busy-flag read: with RW high the data pins are written 1 (PCF8574
+ * quasi-bidirectional) so the HD44780 can drive them. BF is on D7 during
+ * the first E pulse; the second pulse clocks out the address-counter low
+ * nibble, which is discarded.
+ */
+static HAL_StatusTypeDef ReadBusyFlag(uint8_t *busy)
+{
+  uint8_t hi[2] = { 0xF0 | RW | dpBacklight, 0xF0 | RW | ENABLE | dpBacklight };
+  uint8_t lo[3] = { 0xF0 | RW | dpBacklight, 0xF0 | RW | ENABLE | dpBacklight, 0xF0 | RW | dpBacklight };
+  uint8_t in;
+
+  if (HAL_I2C_Master_Transmit(&hi2c1, DEVICE_ADDR, hi, sizeof(hi), 10) != HAL_OK ||
+      HAL_I2C_Master_Receive(&hi2c1, DEVICE_ADDR, &in, 1, 10) != HAL_OK ||
+      HAL_I2C_Master_Transmit(&hi2c1, DEVICE_ADDR, lo, sizeof(lo), 10) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+  wireBytes += (sizeof(hi) + 1) + 2 + (sizeof(lo) + 1);
+  *busy = in & 0x80;
+  return HAL_OK;
+}
+
+/*
+ * Decide once, right after Function Set, whether BF can be polled. On a
+ * module with RW tied to GND every E pulse of a read is a write of
+ * D7..D4 = 1111, so a poll in the middle of a command stream would inject
+ * 0xFF (Set DDRAM 0x7F) commands. Here that one stray command is harmless:
+ * Clear follows and resets the address. The controller is idle after the
+ * 37 us Function Set, so a wired module reads BF = 0 while a strapped one
+ * reads back the expander's own high D7.
+ */
+static void ProbeBusyFlag(void)
+{
+  uint8_t busy;
+
+  busyFlagOk = LCD_BUSY_POLL;
+  if (!busyFlagOk)
+  {
+    return;
+  }
+  TxFlush();
+  TxWaitIdle();
+  DelayUS(100);
+  if (ReadBusyFlag(&busy) != HAL_OK || busy)
+  {
+    busyFlagOk = 0;
+  }
+}
+
+/*
+ * Wait for the last instruction to finish. Polls BF until clear; if the
+ * read fails or BF never clears within twice the datasheet time, polling
+ * is disabled for good and the fixed delay is used instead. RW-strapped
+ * modules never get here: ProbeBusyFlag() turned polling off at init.
+ */
+static void WaitReady(uint32_t fallbackUs)
+{
+  TxFlush();
+  TxWaitIdle();
+  if (busyFlagOk)
+  {
+    uint32_t limit = (SystemCoreClock / 1000000L) * fallbackUs * 2;
+    uint32_t start = DWT->CYCCNT;
+    uint8_t busy;
+
+    do
+    {
+      if (ReadBusyFlag(&busy) != HAL_OK)
+      {
+        break;
+      }
+      if (!busy)
+      {
+        return;
+      }
+    } while (DWT->CYCCNT - start < limit);
+    busyFlagOk = 0;
+  }
+  DelayUS(fallbackUs);
 }
 
 static void Write4Bits(uint8_t value)
@@ -256,7 +489,9 @@ static void Write4Bits(uint8_t value)
 static void ExpanderWrite(uint8_t _data)
 {
   uint8_t data = _data | dpBacklight;
+  TxWaitIdle();
   HAL_I2C_Master_Transmit(&hi2c1, DEVICE_ADDR, (uint8_t*)&data, 1, 10);
+  wireBytes += 2;
 }
 
 static void PulseEnable(uint8_t _data)
@@ -284,7 +519,7 @@ static void DelayInit(void)
   __ASM volatile ("NOP");
 }
 
-static void DelayUS(uint32_t us) {
+static __RAM_FUNC void DelayUS(uint32_t us) {
   uint32_t cycles = (SystemCoreClock/1000000L)*us;
   uint32_t start = DWT->CYCCNT;
   volatile uint32_t cnt;
@@ -315,11 +550,13 @@ void lcdSetCursor(uint8_t row, uint8_t col)
 void lcdWriteString(const char *str)
 {
   HD44780_PrintStr(str);
+  fbPanelValid = 0;  /* Bypassed the framebuffer: redraw all on next flush */
 }
 
 void lcdWriteChar(char ch)
 {
   SendChar(ch);
+  fbPanelValid = 0;
 }
 
 void lcdBacklight(void)
@@ -331,3 +568,227 @@ void lcdNoBacklight(void)
 {
   HD44780_NoBacklight();
 }
+
+/* ========== Shadow Framebuffer ========== */
+
+void lcdFbClear(void)
+{
+  memset(fbShadow, ' ', sizeof(fbShadow));
+}
+
+void lcdFbWrite(uint8_t row, uint8_t col, const char *str)
+{
+  if (row >= LCD_FB_ROWS)
+  {
+    return;
+  }
+  while (*str && col < LCD_FB_COLS)
+  {
+    fbShadow[row][col++] = (uint8_t)*str++;
+  }
+}
+
+/*
+ * Send only the cells that differ from the panel. Dirty runs on a row are
+ * merged across gaps of one clean cell (rewriting it costs the same as a
+ * SETDDRAMADDR), so each run needs exactly one cursor move.
+ * Returns bytes on the wire.
+ */
+uint16_t lcdFlush(void)
+{
+  uint32_t start = wireBytes;
+
+  TxBegin();
+  GlyphUpload();
+  for (uint8_t row = 0; row < LCD_FB_ROWS; row++)
+  {
+    uint8_t col = 0;
+
+    while (col < LCD_FB_COLS)
+    {
+      if (fbPanelValid && fbShadow[row][col] == fbPanel[row][col])
+      {
+        col++;
+        continue;
+      }
+
+      /* Extend the run while dirty, or clean for a single cell followed by dirty */
+      uint8_t end = col + 1;
+      while (end < LCD_FB_COLS)
+      {
+        if (!fbPanelValid || fbShadow[row][end] != fbPanel[row][end])
+        {
+          end++;
+        }
+        else if (end + 1 < LCD_FB_COLS && fbShadow[row][end + 1] != fbPanel[row][end + 1])
+        {
+          end += 2;
+        }
+        else
+        {
+          break;
+        }
+      }
+
+      HD44780_SetCursor(col, row);
+      for (; col < end; col++)
+      {
+        SendChar(fbShadow[row][col]);
+        fbPanel[row][col] = fbShadow[row][col];
+      }
+    }
+  }
+  fbPanelValid = 1;
+  glyphFrame = glyphClock;
+  TxEnd();
+
+  return (uint16_t)(wireBytes - start);
+}
+
+/*
+ * Same diff as lcdFlush(), but the encoded stream goes out via DMA and the
+ * call returns as soon as the transfer is queued. Returns 0 without touching
+ * the shadow if the previous frame is still on the wire; the caller simply
+ * retries on its next period. Any other LCD call waits for completion.
+ */
+uint16_t lcdFlushAsync(void)
+{
+  uint16_t bytes;
+
+  if (txBusy)
+  {
+    return 0;
+  }
+  txAsync = 1;
+  bytes = lcdFlush();
+  txAsync = 0;
+  return bytes;
+}
+
+uint8_t lcdBusy(void)
+{
+  return txBusy;
+}
+
+uint32_t lcdWireBytes(void)
+{
+  return wireBytes;
+}
+
+/* ========== CGRAM Glyph Cache ========== */
+
+static void GlyphReset(void)
+{
+  memset(glyphId, GLYPH_NONE, sizeof(glyphId));
+  memset(glyphUse, 0, sizeof(glyphUse));
+  glyphClock = 0;
+  glyphFrame = 0;
+  glyphDirty = 0;
+  glyphInFlight = 0;
+}
+
+/*
+ * Queue CGRAM writes for changed slots; runs inside the flush batch. On the
+ * DMA path the slots stay in glyphInFlight until the frame completes, so a
+ * dropped frame marks them dirty again.
+ */
+static void GlyphUpload(void)
+{
+  uint8_t upload = glyphDirty;
+
+  glyphDirty = 0;
+  if (txAsync)
+  {
+    glyphInFlight |= upload;
+  }
+  for (uint8_t slot = 0; slot < LCD_GLYPH_SLOTS; slot++)
+  {
+    if (upload & (1 << slot))
+    {
+      SendCommand(LCD_SETCGRAMADDR | (slot << 3));
+      for (uint8_t i = 0; i < 8; i++)
+      {
+        SendChar(glyphMap[slot][i]);
+      }
+    }
+  }
+}
+
+/*
+ * Map a logical glyph to a CGRAM slot and return the character code to put
+ * in the framebuffer. A hit with the same bitmap costs nothing; a changed
+ * bitmap or a miss marks the slot for upload on the next lcdFlush(), which
+ * sends it in the same I2C transaction as the text. Misses evict the least
+ * recently used slot, but never one already requested since the last flush
+ * (it is on the frame being built); if none is left, LCD_GLYPH_FALLBACK.
+ */
+char lcdGlyph(uint8_t id, const uint8_t bitmap[8])
+{
+  uint8_t slot;
+
+  for (slot = 0; slot < LCD_GLYPH_SLOTS; slot++)
+  {
+    if (glyphId[slot] == id)
+    {
+      break;
+    }
+  }
+
+  if (slot == LCD_GLYPH_SLOTS)
+  {
+    slot = 0;
+    for (uint8_t i = 1; i < LCD_GLYPH_SLOTS; i++)
+    {
+      if (glyphUse[i] < glyphUse[slot])
+      {
+        slot = i;
+      }
+    }
+    if (glyphUse[slot] > glyphFrame)
+    {
+      return LCD_GLYPH_FALLBACK;
+    }
+    glyphId[slot] = id;
+    memcpy(glyphMap[slot], bitmap, 8);
+    glyphDirty |= 1 << slot;
+  }
+  else if (memcmp(glyphMap[slot], bitmap, 8) != 0)
+  {
+    memcpy(glyphMap[slot], bitmap, 8);
+    glyphDirty |= 1 << slot;
+  }
+
+  glyphUse[slot] = ++glyphClock;
+  return (char)LCD_GLYPH_CODE(slot);
+}
+
+char lcdIcon(LcdIcon_t icon)
+{
+  if (icon >= LCD_ICON_COUNT)
+  {
+    return LCD_GLYPH_FALLBACK;
+  }
+  return lcdGlyph((uint8_t)icon, iconMap[icon]);
+}
+
+/* ========== HAL I2C Callbacks ========== */
+
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+  if (hi2c == &hi2c1)
+  {
+    txBusy = 0;
+    if (!txBatch)
+    {
+      glyphInFlight = 0;  /* Last transfer of the frame: glyphs are in CGRAM */
+    }
+  }
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+  if (hi2c == &hi2c1 && txBusy)
+  {
+    TxDropped();  /* Partial frame: redraw everything next flush */
+  }
+}
@@ -0,0 +1,60 @@
+/**
+  ******************************************************************************
+  * @file    lm75.c
+  * @brief   LM75 (and compatible) I2C temperature sensor driver
+  ******************************************************************************
+  */
+
+#include "lm75.h"
+
+/* ========== Sensor Operations ========== */
+
+static HAL_StatusTypeDef LM75_Start(void *ctx)
+{
+    (void)ctx;
+    return HAL_OK;  /* Free-running conversion */
+}
+
+/** @brief Ready once the shared bus is idle (LCD DMA flush may own it) */
+static uint8_t LM75_Ready(void *ctx)
+{
+    LM75_t *dev = (LM75_t *)ctx;
+    return HAL_I2C_GetState(dev->hi2c) == HAL_I2C_STATE_READY;
+}
+
+/**
+ * @brief Read the temperature register
+ * @note  Register is a left-aligned 9-bit two's complement value (MSB = degC,
+ *        bit 7 of LSB = 0.5 degC), which is already Q8.8 once the unused
+ *        low bits are masked.
+ */
+static HAL_StatusTypeDef LM75_Read(void *ctx, Temp_t *pTemp)
+{
+    LM75_t *dev = (LM75_t *)ctx;
+    uint8_t buf[2];
+
+    if (HAL_I2C_Mem_Read(dev->hi2c, dev->addr, LM75_REG_TEMP, I2C_MEMADD_SIZE_8BIT,
+                         buf, sizeof(buf), LM75_I2C_TIMEOUT) != HAL_OK)
+    {
+        dev->health = SENSOR_HEALTH_ABSENT;
+        return HAL_ERROR;
+    }
+
+    *pTemp = (Temp_t)(((uint16_t)buf[0] << 8 | buf[1]) & 0xFF80);
+    dev->health = SENSOR_HEALTH_OK;
+    return HAL_OK;
+}
+
+static SensorHealth_t LM75_Health(void *ctx)
+{
+    return ((LM75_t *)ctx)->health;
+}
+
+const SensorOps_t LM75_SensorOps = {
+    "LM75",
+    1,              /* 0.5 degC */
+    LM75_Start,
+    LM75_Ready,
+    LM75_Read,
+    LM75_Health
+};
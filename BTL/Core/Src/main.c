@@ -48,13 +48,17 @@
 
 /* Private variables ---------------------------------------------------------*/
 I2C_HandleTypeDef hi2c1;
+DMA_HandleTypeDef hdma_i2c1_tx;
 
 /* USER CODE BEGIN PV */
 /* Global thermostat state - shared by all tasks */
 ThermostatState_t thermostat_state = {
-    .currentTemp = 0.0f,
+    .currentTemp = 0,
+    .trend = 0,
     .setTemp = 28,          /* Default setpoint: 28°C */
     .isFanOn = 0,
+    .sensorOk = 0,
+    .tempDigits = 1,
     .mode = 1,              /* Start in NORMAL mode */
     .button_up = 0,
     .button_down = 0,
@@ -63,12 +67,12 @@ ThermostatState_t thermostat_state = {
 };
 
 char lcd_buffer[20];     /* Buffer for LCD display */
-float temp_val = 0.0;    /* Variable to store temperature */
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_I2C1_Init(void);
 /* USER CODE BEGIN PFP */
 
@@ -108,6 +112,7 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_I2C1_Init();
   /* USER CODE BEGIN 2 */
 
@@ -126,8 +131,8 @@ int main(void)
   lcdWriteString("BTL Thermostat");
   lcdSetCursor(1, 0);
   lcdWriteString("Initializing...");
-  /* Initialize DS18B20 timer */
-  DS18B20_Init_MicroTimer();
+  /* Initialize DS18B20 timer and 1-Wire pin (open-drain) */
+  DS18B20_Init();
   
   /* ========== Initialize EEPROM and Load Setpoint ========== */
   EEPROM_Init();  /* Initialize EEPROM module */
@@ -242,6 +247,22 @@ static void MX_I2C1_Init(void)
 
 }
 
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA1_Channel6_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Channel6_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Channel6_IRQn);
+
+}
+
 /**
   * @brief GPIO Initialization Function
   * @param None
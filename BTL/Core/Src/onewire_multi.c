@@ -0,0 +1,267 @@
+/**
+  ******************************************************************************
+  * @file    onewire_multi.c
+  * @brief   Parallel bit-banging of up to 16 1-Wire segments on GPIOB
+  * @details Slot layout (same for all segments):
+  *            t=0      BSRR: pull every segment low
+  *            t=2us    BSRR: release segments sending 1 / reading
+  *            t=10us   IDR:  sample every segment
+  *            t=60us   BSRR: release every segment
+  *          BSRR/IDR access is a single bus cycle, so the slot edges on all
+  *          pins are simultaneous. Interrupts are masked from the falling
+  *          edge to the sample (and over the presence window), as in the
+  *          single-bus GPIO driver: an ISR there would stretch a write-1 or
+  *          read low past 15 us. The 60 us write-0 low may run long.
+  ******************************************************************************
+  */
+
+#include "onewire_multi.h"
+#include "DS18B20.h"
+
+/* ========== Private Helpers ========== */
+
+#ifndef ONEWIRE_MULTI_PHY_EXTERNAL
+/**
+ * @brief Microsecond busy-wait on the DWT cycle counter
+ * @param us: Delay in microseconds
+ * @note  Runs from RAM (.RamFunc) with the slot code: no flash wait-state jitter
+ */
+static __RAM_FUNC void delay_us(uint32_t us)
+{
+    uint32_t start = DWT->CYCCNT;
+    uint32_t ticks = us * (SystemCoreClock / 1000000);
+    while ((DWT->CYCCNT - start) < ticks);
+}
+
+/**
+ * @brief Drive slot edges on every segment with one BSRR write
+ * @param bsrr: Set bits release segments, reset bits (<< 16) pull them low
+ */
+static inline __RAM_FUNC void OneWire_Multi_Drive(uint32_t bsrr)
+{
+    ONEWIRE_MULTI_PORT->BSRR = bsrr;
+}
+
+/**
+ * @brief Sample every segment with one IDR read
+ * @retval Port input levels
+ */
+static inline __RAM_FUNC uint16_t OneWire_Multi_Sample(void)
+{
+    return (uint16_t)ONEWIRE_MULTI_PORT->IDR;
+}
+#else
+#define delay_us(us)                OneWire_Multi_PhyDelayUs(us)
+#define OneWire_Multi_Drive(bsrr)   OneWire_Multi_PhyDrive(bsrr)
+#define OneWire_Multi_Sample()      OneWire_Multi_PhySample()
+#endif /* ONEWIRE_MULTI_PHY_EXTERNAL */
+
+/**
+ * @brief 8x8 bit matrix transpose: out[p] bit i = in[i] bit p
+ * @param in: 8 rows
+ * @param out: 8 transposed rows
+ * @note  Hacker's Delight transpose8, three swap stages on two 32-bit halves
+ */
+static void Transpose8(const uint8_t in[8], uint8_t out[8])
+{
+    uint32_t x = ((uint32_t)in[7] << 24) | ((uint32_t)in[6] << 16) | ((uint32_t)in[5] << 8) | in[4];
+    uint32_t y = ((uint32_t)in[3] << 24) | ((uint32_t)in[2] << 16) | ((uint32_t)in[1] << 8) | in[0];
+    uint32_t t;
+
+    t = (x ^ (x >> 7)) & 0x00AA00AA;  x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AA;  y = y ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC; x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCC; y = y ^ t ^ (t << 14);
+    t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+    y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+    x = t;
+
+    out[7] = x >> 24; out[6] = x >> 16; out[5] = x >> 8; out[4] = x;
+    out[3] = y >> 24; out[2] = y >> 16; out[1] = y >> 8; out[0] = y;
+}
+
+/**
+ * @brief One time slot on all segments
+ * @param ones: Segments that send 1 (or read); the others send 0
+ * @retval IDR sampled inside the slot
+ */
+static __RAM_FUNC uint16_t OneWire_Multi_Slot(uint16_t ones)
+{
+    uint16_t sample;
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    OneWire_Multi_Drive((uint32_t)ONEWIRE_MULTI_MASK << 16);
+    delay_us(2);
+    OneWire_Multi_Drive(ones & ONEWIRE_MULTI_MASK);
+    delay_us(8);
+    sample = OneWire_Multi_Sample();
+    __set_PRIMASK(primask);
+    delay_us(50);
+    OneWire_Multi_Drive(ONEWIRE_MULTI_MASK);
+    delay_us(2);
+    return sample;
+}
+
+/**
+ * @brief Eight slots; slot i sends masks[i] and returns its IDR sample
+ * @param masks: Per-slot "send 1" masks (in), IDR samples (out)
+ */
+static void OneWire_Multi_Slots8(uint16_t masks[8])
+{
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        masks[i] = OneWire_Multi_Slot(masks[i]);
+    }
+}
+
+/* ========== Public Functions ========== */
+
+/**
+ * @brief Configure all segment pins as open-drain outputs, bus released
+ */
+void OneWire_Multi_Init(void)
+{
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+    __HAL_RCC_GPIOB_CLK_ENABLE();
+    OneWire_Multi_Drive(ONEWIRE_MULTI_MASK);
+
+    GPIO_InitStruct.Pin = ONEWIRE_MULTI_MASK;
+    GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+    HAL_GPIO_Init(ONEWIRE_MULTI_PORT, &GPIO_InitStruct);
+}
+
+/**
+ * @brief Reset pulse on all segments at once
+ * @retval Mask of segments that answered with a presence pulse
+ */
+uint16_t OneWire_Multi_Reset(void)
+{
+    uint16_t sample;
+    uint32_t primask;
+
+    OneWire_Multi_Drive((uint32_t)ONEWIRE_MULTI_MASK << 16);
+    delay_us(DS18B20_T_RSTL_US);
+
+    /* Presence is only guaranteed low 60..75 us after the release */
+    primask = __get_PRIMASK();
+    __disable_irq();
+    OneWire_Multi_Drive(ONEWIRE_MULTI_MASK);
+    delay_us(DS18B20_T_PRESENCE_US);
+    sample = OneWire_Multi_Sample();
+    __set_PRIMASK(primask);
+    delay_us(DS18B20_T_RSTH_US);
+
+    return (uint16_t)(~sample & ONEWIRE_MULTI_MASK);
+}
+
+/**
+ * @brief Send the same byte on all segments
+ * @param data: Byte to send (LSB first)
+ */
+void OneWire_Multi_WriteByte(uint8_t data)
+{
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        OneWire_Multi_Slot((data & (1 << i)) ? ONEWIRE_MULTI_MASK : 0);
+    }
+}
+
+/**
+ * @brief Send a different byte on each segment in the same 8 slots
+ * @param data: One byte per segment, indexed by pin number
+ */
+void OneWire_Multi_WriteBytes(const uint8_t data[ONEWIRE_MULTI_SEGMENTS])
+{
+    uint8_t lo[8], hi[8];
+    uint16_t masks[8];
+
+    /* Per-segment bytes -> per-slot masks (low and high half of the port) */
+    Transpose8(&data[0], lo);
+    Transpose8(&data[8], hi);
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        masks[i] = ((uint16_t)hi[i] << 8) | lo[i];
+    }
+    OneWire_Multi_Slots8(masks);
+}
+
+/**
+ * @brief Read one byte from every segment in the same 8 slots
+ * @param data: One byte per segment, indexed by pin number
+ */
+void OneWire_Multi_ReadBytes(uint8_t data[ONEWIRE_MULTI_SEGMENTS])
+{
+    uint8_t lo[8], hi[8];
+    uint16_t masks[8];
+
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        masks[i] = ONEWIRE_MULTI_MASK;
+    }
+    OneWire_Multi_Slots8(masks);
+
+    /* Per-slot IDR samples -> per-segment bytes */
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        lo[i] = masks[i] & 0xFF;
+        hi[i] = masks[i] >> 8;
+    }
+    Transpose8(lo, &data[0]);
+    Transpose8(hi, &data[8]);
+}
+
+/**
+ * @brief Start a temperature conversion on every segment (Skip ROM + 0x44)
+ * @retval Mask of segments with a sensor present
+ */
+uint16_t OneWire_Multi_StartConversion(void)
+{
+    uint16_t present = OneWire_Multi_Reset();
+    if (present)
+    {
+        OneWire_Multi_WriteByte(0xCC);  /* Skip ROM */
+        OneWire_Multi_WriteByte(0x44);  /* Convert T */
+    }
+    return present;
+}
+
+/**
+ * @brief Read and CRC-check the scratchpad of one sensor per segment
+ * @param scratchpad: 9 bytes per segment, indexed by pin number
+ * @retval Mask of segments with a present sensor and valid CRC
+ */
+uint16_t OneWire_Multi_ReadScratchpads(uint8_t scratchpad[ONEWIRE_MULTI_SEGMENTS][9])
+{
+    uint8_t column[ONEWIRE_MULTI_SEGMENTS];
+    uint16_t valid = OneWire_Multi_Reset();
+
+    if (valid == 0)
+    {
+        return 0;
+    }
+    OneWire_Multi_WriteByte(0xCC);  /* Skip ROM */
+    OneWire_Multi_WriteByte(0xBE);  /* Read Scratchpad */
+
+    for (uint8_t b = 0; b < DS18B20_SCRATCHPAD_SIZE; b++)
+    {
+        OneWire_Multi_ReadBytes(column);
+        for (uint8_t seg = 0; seg < ONEWIRE_MULTI_SEGMENTS; seg++)
+        {
+            scratchpad[seg][b] = column[seg];
+        }
+    }
+
+    for (uint8_t seg = 0; seg < ONEWIRE_MULTI_SEGMENTS; seg++)
+    {
+        if ((valid & (1 << seg)) &&
+            DS18B20_CRC8(scratchpad[seg], DS18B20_SCRATCHPAD_SIZE - 1) != scratchpad[seg][DS18B20_SCRATCHPAD_SIZE - 1])
+        {
+            valid &= ~(1 << seg);
+        }
+    }
+    return valid;
+}
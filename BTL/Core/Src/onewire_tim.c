@@ -0,0 +1,273 @@
+/**
+  ******************************************************************************
+  * @file    onewire_tim.c
+  * @brief   Background 1-Wire bit engine using TIM1 + DMA1
+  * @details Resources:
+  *            - TIM1 CH1N (PB13, AF open-drain): PWM, active low pulse = slot
+  *            - TIM1 UP  -> DMA1 Channel 5: next pulse width into CCR1
+  *            - TIM1 CH4 -> DMA1 Channel 4: GPIOB->IDR sample per slot
+  *          CCR1 is preloaded, so the value written by DMA after update k
+  *          becomes active at update k+1. The table therefore ends with a
+  *          0 entry: once it is active the pin stays released.
+  *          The DMA TC interrupt (last sample taken) arms the update
+  *          interrupt, which stops the timer at the end of the final slot.
+  ******************************************************************************
+  */
+
+#include "onewire_tim.h"
+#include "DS18B20.h"
+
+/* ========== Engine State ========== */
+static uint16_t ow_pulse[ONEWIRE_TIM_MAX_BITS + 1];  /* Low time per slot + terminator */
+static uint16_t ow_sample[ONEWIRE_TIM_MAX_BITS];     /* Raw IDR per slot */
+static uint16_t ow_nbits = 0;
+static volatile uint8_t ow_busy = 0;
+
+/* ========== Private Helpers ========== */
+
+/**
+ * @brief Load slot timing, arm both DMA channels and start TIM1
+ * @param nslots: Number of slots in ow_pulse[]
+ * @param period: Slot length in microseconds
+ * @param sample: Sample point in microseconds
+ */
+static void OneWire_Tim_Run(uint16_t nslots, uint16_t period, uint16_t sample)
+{
+    ow_nbits = nslots;
+    ow_pulse[nslots] = 0;
+    ow_busy = 1;
+
+    TIM1->CR1 &= ~TIM_CR1_CEN;
+    TIM1->DIER = 0;
+    TIM1->ARR = period - 1;
+    TIM1->CCR4 = sample;
+
+    /* First slot goes straight to the shadow register, second to preload */
+    TIM1->CCR1 = ow_pulse[0];
+    TIM1->EGR = TIM_EGR_UG;
+    TIM1->CCR1 = ow_pulse[1];
+    TIM1->SR = 0;
+
+    /* Update DMA: ow_pulse[2..nslots] -> CCR1 */
+    DMA1_Channel5->CCR &= ~DMA_CCR_EN;
+    if (nslots > 1)
+    {
+        DMA1_Channel5->CMAR = (uint32_t)&ow_pulse[2];
+        DMA1_Channel5->CNDTR = nslots - 1;
+        DMA1_Channel5->CCR |= DMA_CCR_EN;
+    }
+
+    /* CC4 DMA: GPIOB->IDR -> ow_sample[] */
+    DMA1_Channel4->CCR &= ~DMA_CCR_EN;
+    DMA1->IFCR = DMA_IFCR_CGIF4 | DMA_IFCR_CGIF5;
+    DMA1_Channel4->CMAR = (uint32_t)ow_sample;
+    DMA1_Channel4->CNDTR = nslots;
+    DMA1_Channel4->CCR |= DMA_CCR_EN;
+
+    TIM1->DIER = ((nslots > 1) ? TIM_DIER_UDE : 0) | TIM_DIER_CC4DE;
+    TIM1->CR1 |= TIM_CR1_CEN;
+}
+
+/* ========== Public Functions ========== */
+
+/**
+ * @brief Configure TIM1, DMA1 channels 4/5 and PB13 as TIM1_CH1N open-drain
+ */
+void OneWire_Tim_Init(void)
+{
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+    __HAL_RCC_TIM1_CLK_ENABLE();
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    __HAL_RCC_GPIOB_CLK_ENABLE();
+
+    /* 1 MHz timer clock, PWM mode 1 on CH1 with preload, CH4 compare only */
+    TIM1->CR1 = TIM_CR1_ARPE | TIM_CR1_URS;
+    TIM1->PSC = (HAL_RCC_GetPCLK2Freq() / 1000000U) - 1;
+    TIM1->CCMR1 = TIM_CCMR1_OC1M_2 | TIM_CCMR1_OC1M_1 | TIM_CCMR1_OC1PE;
+    TIM1->CCMR2 = 0;
+    TIM1->CCR1 = 0;
+
+    /* CH1 disabled, CH1N enabled and inverted: OC1N = !OC1REF = low during pulse */
+    TIM1->CCER = TIM_CCER_CC1NE | TIM_CCER_CC1NP;
+    TIM1->BDTR = TIM_BDTR_MOE;
+    TIM1->EGR = TIM_EGR_UG;
+
+    /* DMA1 Channel 5: memory -> TIM1->CCR1, 16-bit */
+    DMA1_Channel5->CCR = DMA_CCR_DIR | DMA_CCR_MINC | DMA_CCR_PSIZE_0 | DMA_CCR_MSIZE_0 | DMA_CCR_PL_1;
+    DMA1_Channel5->CPAR = (uint32_t)&TIM1->CCR1;
+
+    /* DMA1 Channel 4: GPIOB->IDR -> memory, 16-bit, transfer complete IRQ */
+    DMA1_Channel4->CCR = DMA_CCR_MINC | DMA_CCR_PSIZE_0 | DMA_CCR_MSIZE_0 | DMA_CCR_PL_1 | DMA_CCR_TCIE;
+    DMA1_Channel4->CPAR = (uint32_t)&DS18B20_PORT->IDR;
+
+    HAL_NVIC_SetPriority(DMA1_Channel4_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel4_IRQn);
+    HAL_NVIC_SetPriority(TIM1_UP_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(TIM1_UP_IRQn);
+
+    /* Hand the pin to the timer (released while OC1REF is low) */
+    GPIO_InitStruct.Pin = DS18B20_PIN;
+    GPIO_InitStruct.Mode = GPIO_MODE_AF_OD;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+    HAL_GPIO_Init(DS18B20_PORT, &GPIO_InitStruct);
+}
+
+/**
+ * @brief Start a reset/presence slot in the background
+ * @retval HAL_OK if started, HAL_BUSY if a transaction is in progress
+ */
+HAL_StatusTypeDef OneWire_Tim_StartReset(void)
+{
+    if (ow_busy)
+    {
+        return HAL_BUSY;
+    }
+
+    ow_pulse[0] = ONEWIRE_TIM_RESET_US;
+    OneWire_Tim_Run(1, ONEWIRE_TIM_RSTSLOT_US, ONEWIRE_TIM_PRESENCE_US);
+    return HAL_OK;
+}
+
+/**
+ * @brief Start a bit transaction in the background
+ * @param tx: Bits to send, LSB first (1 also means "read slot")
+ * @param nbits: Number of time slots (1..ONEWIRE_TIM_MAX_BITS)
+ * @retval HAL_OK if started, HAL_BUSY if busy, HAL_ERROR on bad length
+ */
+HAL_StatusTypeDef OneWire_Tim_StartTransfer(const uint8_t *tx, uint16_t nbits)
+{
+    if (ow_busy)
+    {
+        return HAL_BUSY;
+    }
+    if (tx == NULL || nbits == 0 || nbits > ONEWIRE_TIM_MAX_BITS)
+    {
+        return HAL_ERROR;
+    }
+
+    for (uint16_t i = 0; i < nbits; i++)
+    {
+        ow_pulse[i] = (tx[i >> 3] & (1 << (i & 7))) ? ONEWIRE_TIM_WRITE1_US : ONEWIRE_TIM_WRITE0_US;
+    }
+    OneWire_Tim_Run(nbits, ONEWIRE_TIM_SLOT_US, ONEWIRE_TIM_SAMPLE_US);
+    return HAL_OK;
+}
+
+/**
+ * @brief Check whether a transaction is still running
+ * @retval 1 if busy, 0 if idle
+ */
+uint8_t OneWire_Tim_IsBusy(void)
+{
+    return ow_busy;
+}
+
+/**
+ * @brief Copy sampled bits of the last transaction (LSB first)
+ * @param rx: Destination, (nbits + 7) / 8 bytes
+ * @param nbits: Number of bits to copy
+ */
+void OneWire_Tim_GetResult(uint8_t *rx, uint16_t nbits)
+{
+    if (nbits > ow_nbits)
+    {
+        nbits = ow_nbits;
+    }
+    for (uint16_t i = 0; i < nbits; i++)
+    {
+        if ((i & 7) == 0)
+        {
+            rx[i >> 3] = 0;
+        }
+        if (ow_sample[i] & DS18B20_PIN)
+        {
+            rx[i >> 3] |= (1 << (i & 7));
+        }
+    }
+}
+
+/**
+ * @brief Result of the last reset slot
+ * @retval 1 if a presence pulse was detected, 0 otherwise
+ */
+uint8_t OneWire_Tim_Presence(void)
+{
+    return (ow_sample[0] & DS18B20_PIN) == 0;
+}
+
+/**
+ * @brief Blocking reset: sleep until the slot has finished
+ * @retval 1 if a presence pulse was detected, 0 otherwise
+ */
+uint8_t OneWire_Tim_Reset(void)
+{
+    while (OneWire_Tim_StartReset() != HAL_OK)
+    {
+        __WFI();
+    }
+    while (ow_busy)
+    {
+        __WFI();
+    }
+    return OneWire_Tim_Presence();
+}
+
+/**
+ * @brief Blocking transfer: sleep until all slots have finished
+ * @param tx: Bits to send, LSB first
+ * @param rx: Sampled bits, may be NULL
+ * @param nbits: Number of time slots
+ */
+void OneWire_Tim_Transfer(const uint8_t *tx, uint8_t *rx, uint16_t nbits)
+{
+    HAL_StatusTypeDef status;
+
+    while ((status = OneWire_Tim_StartTransfer(tx, nbits)) == HAL_BUSY)
+    {
+        __WFI();
+    }
+    if (status != HAL_OK)
+    {
+        return;
+    }
+    while (ow_busy)
+    {
+        __WFI();
+    }
+    if (rx != NULL)
+    {
+        OneWire_Tim_GetResult(rx, nbits);
+    }
+}
+
+/* ========== Interrupt Handlers ========== */
+
+/**
+ * @brief DMA1 Channel 4 TC: last sample taken, stop at the end of this slot
+ */
+void OneWire_Tim_DMA_IRQHandler(void)
+{
+    if (DMA1->ISR & DMA_ISR_TCIF4)
+    {
+        DMA1->IFCR = DMA_IFCR_CGIF4;
+        DMA1_Channel4->CCR &= ~DMA_CCR_EN;
+        TIM1->SR = ~TIM_SR_UIF;
+        TIM1->DIER |= TIM_DIER_UIE;
+    }
+}
+
+/**
+ * @brief TIM1 update after the final slot: CCR1 is now 0, stop the timer
+ */
+void OneWire_Tim_UP_IRQHandler(void)
+{
+    if (TIM1->SR & TIM_SR_UIF)
+    {
+        TIM1->CR1 &= ~TIM_CR1_CEN;
+        TIM1->DIER = 0;
+        TIM1->SR = ~TIM_SR_UIF;
+        DMA1_Channel5->CCR &= ~DMA_CCR_EN;
+        ow_busy = 0;
+    }
+}
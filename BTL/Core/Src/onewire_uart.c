@@ -0,0 +1,245 @@
+/**
+  ******************************************************************************
+  * @file    onewire_uart.c
+  * @brief   1-Wire transport over USART3 in single-wire half-duplex mode
+  * @details Resources:
+  *            - USART3 TX (PB10, AF open-drain, HDSEL): shared data line
+  *            - DMA1 Channel 2: slot frames -> USART3->DR
+  *            - DMA1 Channel 3: USART3->DR -> echoed frames (TC interrupt)
+  *          In half-duplex mode the receiver sees the line itself, so each
+  *          echoed frame is what the bus looked like during that slot. A
+  *          slave answering 0 stretches the start bit and clears the LSBs.
+  ******************************************************************************
+  */
+
+#include "onewire_uart.h"
+
+/* ========== Transport State ========== */
+static uint8_t ow_tx[ONEWIRE_UART_MAX_BITS];     /* One UART frame per slot */
+static uint8_t ow_rx[ONEWIRE_UART_MAX_BITS];     /* Echo of each slot */
+static uint16_t ow_nbits = 0;
+static volatile uint8_t ow_busy = 0;
+
+/* ========== Private Helpers ========== */
+
+/**
+ * @brief Program the USART3 baud rate (bus must be idle)
+ * @param baud: Baud rate
+ */
+static void OneWire_Uart_SetBaud(uint32_t baud)
+{
+    uint32_t pclk = HAL_RCC_GetPCLK1Freq();
+    USART3->BRR = (pclk + baud / 2) / baud;
+}
+
+/**
+ * @brief Arm RX and TX DMA for nframes frames and start sending
+ * @param nframes: Number of frames in ow_tx[]
+ */
+static void OneWire_Uart_Run(uint16_t nframes)
+{
+    ow_nbits = nframes;
+    ow_busy = 1;
+
+    /* Drop any stale byte / overrun left in the receiver */
+    (void)USART3->SR;
+    (void)USART3->DR;
+
+    DMA1_Channel2->CCR &= ~DMA_CCR_EN;
+    DMA1_Channel3->CCR &= ~DMA_CCR_EN;
+    DMA1->IFCR = DMA_IFCR_CGIF2 | DMA_IFCR_CGIF3;
+
+    /* RX first so no echoed frame can be missed */
+    DMA1_Channel3->CMAR = (uint32_t)ow_rx;
+    DMA1_Channel3->CNDTR = nframes;
+    DMA1_Channel3->CCR |= DMA_CCR_EN;
+
+    DMA1_Channel2->CMAR = (uint32_t)ow_tx;
+    DMA1_Channel2->CNDTR = nframes;
+    DMA1_Channel2->CCR |= DMA_CCR_EN;
+}
+
+/* ========== Public Functions ========== */
+
+/**
+ * @brief Configure USART3 half-duplex, DMA1 channels 2/3 and PB10 open-drain
+ */
+void OneWire_Uart_Init(void)
+{
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+    __HAL_RCC_USART3_CLK_ENABLE();
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    __HAL_RCC_GPIOB_CLK_ENABLE();
+
+    /* 8N1, TX + RX, single-wire half-duplex, DMA on both directions */
+    USART3->CR1 = 0;
+    USART3->CR2 = 0;
+    USART3->CR3 = USART_CR3_HDSEL | USART_CR3_DMAT | USART_CR3_DMAR;
+    OneWire_Uart_SetBaud(ONEWIRE_UART_DATA_BAUD);
+    USART3->CR1 = USART_CR1_UE | USART_CR1_TE | USART_CR1_RE;
+
+    /* DMA1 Channel 2: memory -> USART3->DR, 8-bit */
+    DMA1_Channel2->CCR = DMA_CCR_DIR | DMA_CCR_MINC | DMA_CCR_PL_1;
+    DMA1_Channel2->CPAR = (uint32_t)&USART3->DR;
+
+    /* DMA1 Channel 3: USART3->DR -> memory, 8-bit, transfer complete IRQ */
+    DMA1_Channel3->CCR = DMA_CCR_MINC | DMA_CCR_PL_1 | DMA_CCR_TCIE;
+    DMA1_Channel3->CPAR = (uint32_t)&USART3->DR;
+
+    HAL_NVIC_SetPriority(DMA1_Channel3_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel3_IRQn);
+
+    /* Half-duplex TX pin: open-drain, external pull-up holds the bus high */
+    GPIO_InitStruct.Pin = ONEWIRE_UART_PIN;
+    GPIO_InitStruct.Mode = GPIO_MODE_AF_OD;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+    HAL_GPIO_Init(ONEWIRE_UART_PORT, &GPIO_InitStruct);
+}
+
+/**
+ * @brief Start a reset/presence frame in the background
+ * @retval HAL_OK if started, HAL_BUSY if a transaction is in progress
+ */
+HAL_StatusTypeDef OneWire_Uart_StartReset(void)
+{
+    if (ow_busy)
+    {
+        return HAL_BUSY;
+    }
+
+    OneWire_Uart_SetBaud(ONEWIRE_UART_RESET_BAUD);
+    ow_tx[0] = ONEWIRE_UART_RESET_BYTE;
+    OneWire_Uart_Run(1);
+    return HAL_OK;
+}
+
+/**
+ * @brief Start a bit transaction in the background
+ * @param tx: Bits to send, LSB first (1 also means "read slot")
+ * @param nbits: Number of time slots (1..ONEWIRE_UART_MAX_BITS)
+ * @retval HAL_OK if started, HAL_BUSY if busy, HAL_ERROR on bad length
+ */
+HAL_StatusTypeDef OneWire_Uart_StartTransfer(const uint8_t *tx, uint16_t nbits)
+{
+    if (ow_busy)
+    {
+        return HAL_BUSY;
+    }
+    if (tx == NULL || nbits == 0 || nbits > ONEWIRE_UART_MAX_BITS)
+    {
+        return HAL_ERROR;
+    }
+
+    for (uint16_t i = 0; i < nbits; i++)
+    {
+        ow_tx[i] = (tx[i >> 3] & (1 << (i & 7))) ? 0xFF : 0x00;
+    }
+    OneWire_Uart_SetBaud(ONEWIRE_UART_DATA_BAUD);
+    OneWire_Uart_Run(nbits);
+    return HAL_OK;
+}
+
+/**
+ * @brief Check whether a transaction is still running
+ * @retval 1 if busy, 0 if idle
+ */
+uint8_t OneWire_Uart_IsBusy(void)
+{
+    return ow_busy;
+}
+
+/**
+ * @brief Copy sampled bits of the last transaction (LSB first)
+ * @param rx: Destination, (nbits + 7) / 8 bytes
+ * @param nbits: Number of bits to copy
+ */
+void OneWire_Uart_GetResult(uint8_t *rx, uint16_t nbits)
+{
+    if (nbits > ow_nbits)
+    {
+        nbits = ow_nbits;
+    }
+    for (uint16_t i = 0; i < nbits; i++)
+    {
+        if ((i & 7) == 0)
+        {
+            rx[i >> 3] = 0;
+        }
+        if (ow_rx[i] == 0xFF)
+        {
+            rx[i >> 3] |= (1 << (i & 7));
+        }
+    }
+}
+
+/**
+ * @brief Result of the last reset frame
+ * @retval 1 if a presence pulse was detected, 0 otherwise
+ */
+uint8_t OneWire_Uart_Presence(void)
+{
+    /* 0xF0 echoed unchanged: nobody answered; 0x00: bus shorted low */
+    return (ow_rx[0] != ONEWIRE_UART_RESET_BYTE) && (ow_rx[0] != 0x00);
+}
+
+/**
+ * @brief Blocking reset: sleep until the frame has been echoed
+ * @retval 1 if a presence pulse was detected, 0 otherwise
+ */
+uint8_t OneWire_Uart_Reset(void)
+{
+    while (OneWire_Uart_StartReset() != HAL_OK)
+    {
+        __WFI();
+    }
+    while (ow_busy)
+    {
+        __WFI();
+    }
+    return OneWire_Uart_Presence();
+}
+
+/**
+ * @brief Blocking transfer: sleep until all frames have been echoed
+ * @param tx: Bits to send, LSB first
+ * @param rx: Sampled bits, may be NULL
+ * @param nbits: Number of time slots
+ */
+void OneWire_Uart_Transfer(const uint8_t *tx, uint8_t *rx, uint16_t nbits)
+{
+    HAL_StatusTypeDef status;
+
+    while ((status = OneWire_Uart_StartTransfer(tx, nbits)) == HAL_BUSY)
+    {
+        __WFI();
+    }
+    if (status != HAL_OK)
+    {
+        return;
+    }
+    while (ow_busy)
+    {
+        __WFI();
+    }
+    if (rx != NULL)
+    {
+        OneWire_Uart_GetResult(rx, nbits);
+    }
+}
+
+/* ========== Interrupt Handler ========== */
+
+/**
+ * @brief DMA1 Channel 3 TC: last echoed frame received, transaction done
+ */
+void OneWire_Uart_DMA_IRQHandler(void)
+{
+    if (DMA1->ISR & DMA_ISR_TCIF3)
+    {
+        DMA1->IFCR = DMA_IFCR_CGIF3 | DMA_IFCR_CGIF2;
+        DMA1_Channel3->CCR &= ~DMA_CCR_EN;
+        DMA1_Channel2->CCR &= ~DMA_CCR_EN;
+        ow_busy = 0;
+    }
+}
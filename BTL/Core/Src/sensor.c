@@ -0,0 +1,150 @@
+/**
+  ******************************************************************************
+  * @file    sensor.c
+  * @brief   Pluggable temperature sensor interface
+  * @details Per sensor: IDLE --period--> start() --> CONVERTING
+  *          CONVERTING --ready()--> read() --> IDLE
+  *          CONVERTING --timeout--> IDLE (reading marked invalid)
+  *          start() returning HAL_BUSY (bus locked) is retried next poll.
+  *          With oversampling, valid readings are summed and one output is
+  *          produced every 2^shift readings (decimation); a failed reading
+  *          discards the partial sum so outputs never straddle a gap.
+  ******************************************************************************
+  */
+
+#include "sensor.h"
+
+/* ========== Private Helpers ========== */
+
+/**
+ * @brief Add one reading to the oversampling accumulator
+ * @param sensor: Sensor instance
+ * @param temp: Reading (Q8.8 degC)
+ * @retval 1 if a decimated output was stored in sensor->temp
+ */
+static uint8_t Sensor_Decimate(Sensor_t *sensor, Temp_t temp)
+{
+    uint8_t shift = sensor->oversampleShift;
+
+    if (shift == 0)
+    {
+        sensor->temp = temp;
+        return 1;
+    }
+
+    sensor->acc += temp;
+    if (++sensor->accCount < (1U << shift))
+    {
+        return 0;
+    }
+
+    /* Rounded mean, stays Q8.8: the extra bits fill the 1/256 headroom */
+    sensor->temp = (Temp_t)((sensor->acc + (1L << (shift - 1))) >> shift);
+    sensor->acc = 0;
+    sensor->accCount = 0;
+    return 1;
+}
+
+/* ========== Public Functions ========== */
+
+/**
+ * @brief Reset scheduling state so the next poll starts a conversion
+ * @param sensor: Sensor instance
+ * @param now: Current HAL_GetTick()
+ */
+void Sensor_Init(Sensor_t *sensor, uint32_t now)
+{
+    sensor->state = SENSOR_STATE_IDLE;
+    sensor->startTick = now - sensor->periodMs;
+    sensor->valid = 0;
+    sensor->acc = 0;
+    sensor->accCount = 0;
+    if (sensor->oversampleShift > SENSOR_OVERSAMPLE_MAX_SHIFT)
+    {
+        sensor->oversampleShift = SENSOR_OVERSAMPLE_MAX_SHIFT;
+    }
+}
+
+/**
+ * @brief Advance the start/poll/read cycle of one sensor (never blocks)
+ * @param sensor: Sensor instance
+ * @param now: Current HAL_GetTick()
+ * @retval 1 if a new valid reading was stored in sensor->temp, 0 otherwise
+ */
+uint8_t Sensor_Poll(Sensor_t *sensor, uint32_t now)
+{
+    Temp_t temp;
+
+    if (sensor->state == SENSOR_STATE_IDLE)
+    {
+        if ((now - sensor->startTick) >= sensor->periodMs)
+        {
+            HAL_StatusTypeDef status;
+
+            sensor->startTick = now;
+            status = sensor->ops->start(sensor->ctx);
+            if (status == HAL_OK)
+            {
+                sensor->state = SENSOR_STATE_CONVERTING;
+            }
+            else if (status == HAL_BUSY)
+            {
+                /* Bus held by someone else: retry on the next poll */
+                sensor->startTick = now - sensor->periodMs;
+            }
+            else
+            {
+                sensor->valid = 0;
+            }
+        }
+        return 0;
+    }
+
+    /* CONVERTING */
+    if (sensor->ops->ready(sensor->ctx))
+    {
+        sensor->state = SENSOR_STATE_IDLE;
+        if (sensor->ops->read(sensor->ctx, &temp) == HAL_OK)
+        {
+            if (Sensor_Decimate(sensor, temp))
+            {
+                sensor->valid = 1;
+                return 1;
+            }
+            return 0;
+        }
+        sensor->valid = 0;
+        sensor->acc = 0;
+        sensor->accCount = 0;
+    }
+    else if ((now - sensor->startTick) >= sensor->timeoutMs)
+    {
+        sensor->state = SENSOR_STATE_IDLE;
+        sensor->valid = 0;
+        sensor->acc = 0;
+        sensor->accCount = 0;
+    }
+    return 0;
+}
+
+/**
+ * @brief Health as reported by the driver
+ * @param sensor: Sensor instance
+ * @retval SensorHealth_t
+ */
+SensorHealth_t Sensor_Health(const Sensor_t *sensor)
+{
+    return sensor->ops->health(sensor->ctx);
+}
+
+/**
+ * @brief Effective resolution of sensor->temp after oversampling
+ * @param sensor: Sensor instance
+ * @retval Fractional bits that carry information (<= TEMP_FRAC_BITS)
+ */
+uint8_t Sensor_ResolutionBits(const Sensor_t *sensor)
+{
+    uint8_t bits = sensor->ops->fracBits + sensor->oversampleShift / 2;
+
+    return (bits > TEMP_FRAC_BITS) ? TEMP_FRAC_BITS : bits;
+}
@@ -0,0 +1,103 @@
+/**
+  ******************************************************************************
+  * @file    sht3x.c
+  * @brief   SHT3x (SHT30/31/35) I2C temperature/humidity sensor driver
+  ******************************************************************************
+  */
+
+#include "sht3x.h"
+
+/* ========== Private Helpers ========== */
+
+/**
+ * @brief Sensirion CRC8 (poly 0x31, init 0xFF) over one 16-bit word
+ * @param data: Pointer to 2 bytes
+ * @retval CRC8
+ */
+static uint8_t SHT3x_CRC8(const uint8_t *data)
+{
+    uint8_t crc = 0xFF;
+
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/* ========== Sensor Operations ========== */
+
+static HAL_StatusTypeDef SHT3x_Start(void *ctx)
+{
+    SHT3x_t *dev = (SHT3x_t *)ctx;
+    uint8_t cmd[2] = { SHT3X_CMD_MEASURE_HIGH >> 8, SHT3X_CMD_MEASURE_HIGH & 0xFF };
+
+    if (HAL_I2C_GetState(dev->hi2c) != HAL_I2C_STATE_READY)
+    {
+        return HAL_BUSY;  /* LCD DMA flush in progress: retry next poll */
+    }
+    if (HAL_I2C_Master_Transmit(dev->hi2c, dev->addr, cmd, sizeof(cmd), SHT3X_I2C_TIMEOUT) != HAL_OK)
+    {
+        dev->health = SENSOR_HEALTH_ABSENT;
+        return HAL_ERROR;
+    }
+    dev->startTick = HAL_GetTick();
+    return HAL_OK;
+}
+
+static uint8_t SHT3x_Ready(void *ctx)
+{
+    SHT3x_t *dev = (SHT3x_t *)ctx;
+    return (HAL_GetTick() - dev->startTick) >= SHT3X_CONVERSION_MS
+        && HAL_I2C_GetState(dev->hi2c) == HAL_I2C_STATE_READY;
+}
+
+/**
+ * @brief Read T and RH words (each followed by its CRC)
+ * @note  T  = -45 + 175 * raw / 65535 degC, RH = 100 * raw / 65535 %
+ *        computed in Q8.8 with unsigned 32-bit math (175 * 256 * 65535 < 2^32)
+ */
+static HAL_StatusTypeDef SHT3x_Read(void *ctx, Temp_t *pTemp)
+{
+    SHT3x_t *dev = (SHT3x_t *)ctx;
+    uint8_t buf[6];
+
+    if (HAL_I2C_Master_Receive(dev->hi2c, dev->addr, buf, sizeof(buf), SHT3X_I2C_TIMEOUT) != HAL_OK)
+    {
+        dev->health = SENSOR_HEALTH_ABSENT;
+        return HAL_ERROR;
+    }
+    if (SHT3x_CRC8(&buf[0]) != buf[2] || SHT3x_CRC8(&buf[3]) != buf[5])
+    {
+        dev->health = SENSOR_HEALTH_ERROR;
+        return HAL_ERROR;
+    }
+
+    uint32_t rawT = ((uint32_t)buf[0] << 8) | buf[1];
+    uint32_t rawRH = ((uint32_t)buf[3] << 8) | buf[4];
+    int32_t temp = (int32_t)((175UL * 256UL * rawT) / 65535UL) - 45 * TEMP_ONE;
+
+    /* Q8.8 ends at 127.99 degC, the sensor at 130 degC: saturate, don't wrap */
+    *pTemp = (Temp_t)((temp > INT16_MAX) ? INT16_MAX : temp);
+    dev->humidity = (uint16_t)((100UL * 256UL * rawRH) / 65535UL);
+    dev->health = SENSOR_HEALTH_OK;
+    return HAL_OK;
+}
+
+static SensorHealth_t SHT3x_Health(void *ctx)
+{
+    return ((SHT3x_t *)ctx)->health;
+}
+
+const SensorOps_t SHT3x_SensorOps = {
+    "SHT3x",
+    TEMP_FRAC_BITS, /* 16-bit raw, finer than Q8.8 */
+    SHT3x_Start,
+    SHT3x_Ready,
+    SHT3x_Read,
+    SHT3x_Health
+};
@@ -22,6 +22,12 @@
 #include "stm32f1xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "DS18B20.h"
+#if DS18B20_TRANSPORT == DS18B20_TRANSPORT_TIM
+#include "onewire_tim.h"
+#elif DS18B20_TRANSPORT == DS18B20_TRANSPORT_UART
+#include "onewire_uart.h"
+#endif
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -55,6 +61,8 @@
 /* USER CODE END 0 */
 
 /* External variables --------------------------------------------------------*/
+extern DMA_HandleTypeDef hdma_i2c1_tx;
+extern I2C_HandleTypeDef hi2c1;
 
 /* USER CODE BEGIN EV */
 
@@ -198,6 +206,72 @@ void SysTick_Handler(void)
 /* please refer to the startup file (startup_stm32f1xx.s).                    */
 /******************************************************************************/
 
+/**
+  * @brief This function handles DMA1 channel6 global interrupt.
+  */
+void DMA1_Channel6_IRQHandler(void)
+{
+  /* USER CODE BEGIN DMA1_Channel6_IRQn 0 */
+
+  /* USER CODE END DMA1_Channel6_IRQn 0 */
+  HAL_DMA_IRQHandler(&hdma_i2c1_tx);
+  /* USER CODE BEGIN DMA1_Channel6_IRQn 1 */
+
+  /* USER CODE END DMA1_Channel6_IRQn 1 */
+}
+
+/**
+  * @brief This function handles I2C1 event interrupt.
+  */
+void I2C1_EV_IRQHandler(void)
+{
+  /* USER CODE BEGIN I2C1_EV_IRQn 0 */
+
+  /* USER CODE END I2C1_EV_IRQn 0 */
+  HAL_I2C_EV_IRQHandler(&hi2c1);
+  /* USER CODE BEGIN I2C1_EV_IRQn 1 */
+
+  /* USER CODE END I2C1_EV_IRQn 1 */
+}
+
+/**
+  * @brief This function handles I2C1 error interrupt.
+  */
+void I2C1_ER_IRQHandler(void)
+{
+  /* USER CODE BEGIN I2C1_ER_IRQn 0 */
+
+  /* USER CODE END I2C1_ER_IRQn 0 */
+  HAL_I2C_ER_IRQHandler(&hi2c1);
+  /* USER CODE BEGIN I2C1_ER_IRQn 1 */
+
+  /* USER CODE END I2C1_ER_IRQn 1 */
+}
+
 /* USER CODE BEGIN 1 */
+#if DS18B20_TRANSPORT == DS18B20_TRANSPORT_TIM
+/**
+  * @brief This function handles DMA1 channel4 global interrupt (1-Wire samples).
+  */
+void DMA1_Channel4_IRQHandler(void)
+{
+  OneWire_Tim_DMA_IRQHandler();
+}
 
+/**
+  * @brief This function handles TIM1 update interrupt (1-Wire end of transaction).
+  */
+void TIM1_UP_IRQHandler(void)
+{
+  OneWire_Tim_UP_IRQHandler();
+}
+#elif DS18B20_TRANSPORT == DS18B20_TRANSPORT_UART
+/**
+  * @brief This function handles DMA1 channel3 global interrupt (1-Wire USART3 RX).
+  */
+void DMA1_Channel3_IRQHandler(void)
+{
+  OneWire_Uart_DMA_IRQHandler();
+}
+#endif
 /* USER CODE END 1 */
@@ -0,0 +1,93 @@
+/**
+  ******************************************************************************
+  * @file    temp_filter.c
+  * @brief   Sensor sample filter: median-of-N spike rejection + integer EMA
+  * @details Stage 1: median of the last TEMP_FILTER_MEDIAN_N raw samples
+  *                   rejects single-sample spikes (bit errors, EMI).
+  *          Stage 2: EMA with weight 1/2^TEMP_FILTER_EMA_SHIFT smooths the
+  *                   remaining noise. The accumulator keeps the extra
+  *                   fractional bits so small steps are not truncated away.
+  ******************************************************************************
+  */
+
+#include "temp_filter.h"
+
+#if (TEMP_FILTER_MEDIAN_N < 1) || ((TEMP_FILTER_MEDIAN_N & 1) == 0)
+#error "TEMP_FILTER_MEDIAN_N must be odd and >= 1"
+#endif
+
+/* ========== Private Helpers ========== */
+
+/**
+ * @brief Median of the window (insertion sort on a copy, fixed N)
+ * @param window: TEMP_FILTER_MEDIAN_N samples
+ * @retval Median value
+ */
+static Temp_t TempFilter_Median(const Temp_t *window)
+{
+    Temp_t sorted[TEMP_FILTER_MEDIAN_N];
+
+    for (uint8_t i = 0; i < TEMP_FILTER_MEDIAN_N; i++)
+    {
+        Temp_t v = window[i];
+        uint8_t j = i;
+        while (j > 0 && sorted[j - 1] > v)
+        {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+    return sorted[TEMP_FILTER_MEDIAN_N / 2];
+}
+
+/* ========== Public Functions ========== */
+
+/**
+ * @brief Reset the filter; the next sample primes the window and the EMA
+ * @param filter: Filter instance
+ */
+void TempFilter_Init(TempFilter_t *filter)
+{
+    for (uint8_t i = 0; i < TEMP_FILTER_MEDIAN_N; i++)
+    {
+        filter->window[i] = 0;
+    }
+    filter->head = 0;
+    filter->primed = 0;
+    filter->ema = 0;
+}
+
+/**
+ * @brief Push one raw sample and get the filtered one
+ * @param filter: Filter instance
+ * @param sample: Raw sample from the driver
+ * @retval Filtered sample (same timestamp as the input)
+ */
+TempSample_t TempFilter_Update(TempFilter_t *filter, TempSample_t sample)
+{
+    TempSample_t out = sample;
+    Temp_t median;
+
+    if (!filter->primed)
+    {
+        /* Start from the first reading instead of ramping up from 0 degC */
+        for (uint8_t i = 0; i < TEMP_FILTER_MEDIAN_N; i++)
+        {
+            filter->window[i] = sample.value;
+        }
+        filter->ema = (int32_t)sample.value * (1 << TEMP_FILTER_EMA_SHIFT);
+        filter->primed = 1;
+    }
+
+    /* Stage 1: median of the last N samples */
+    filter->window[filter->head] = sample.value;
+    filter->head = (filter->head + 1) % TEMP_FILTER_MEDIAN_N;
+    median = TempFilter_Median(filter->window);
+
+    /* Stage 2: ema += x - ema / 2^k, output = ema / 2^k (arithmetic shift) */
+    filter->ema += median - (filter->ema >> TEMP_FILTER_EMA_SHIFT);
+    out.value = (Temp_t)(filter->ema >> TEMP_FILTER_EMA_SHIFT);
+
+    return out;
+}
@@ -0,0 +1,75 @@
+/**
+  ******************************************************************************
+  * @file    temp_history.c
+  * @brief   Downsampled temperature history for the display sparkline
+  ******************************************************************************
+  */
+
+#include "temp_history.h"
+
+/* ========== Public Functions ========== */
+
+/**
+ * @brief Clear the ring and the open period
+ * @param hist: History instance
+ */
+void TempHistory_Init(TempHistory_t *hist)
+{
+    hist->head = 0;
+    hist->count = 0;
+    hist->acc = 0;
+    hist->accCount = 0;
+    hist->periodStart = 0;
+}
+
+/**
+ * @brief Accumulate one (filtered) sample
+ * @param hist: History instance
+ * @param sample: Sample with its timestamp
+ * @retval 1 if a period closed and a new entry was pushed, 0 otherwise
+ */
+uint8_t TempHistory_Update(TempHistory_t *hist, TempSample_t sample)
+{
+    uint8_t pushed = 0;
+
+    if (hist->accCount != 0 && (sample.timestamp - hist->periodStart) >= TEMP_HISTORY_PERIOD_MS)
+    {
+        /* Period over: push its rounded mean, this sample opens the next one */
+        int32_t half = hist->accCount / 2;
+        hist->ring[hist->head] = (Temp_t)((hist->acc >= 0) ? (hist->acc + half) / hist->accCount
+                                                           : (hist->acc - half) / hist->accCount);
+        hist->head = (uint8_t)((hist->head + 1) % TEMP_HISTORY_LEN);
+        if (hist->count < TEMP_HISTORY_LEN)
+        {
+            hist->count++;
+        }
+        hist->acc = 0;
+        hist->accCount = 0;
+        pushed = 1;
+    }
+
+    if (hist->accCount == 0)
+    {
+        hist->periodStart = sample.timestamp;
+    }
+    hist->acc += sample.value;
+    hist->accCount++;
+    return pushed;
+}
+
+/**
+ * @brief Entry by age
+ * @param hist: History instance
+ * @param index: 0 = oldest, count - 1 = newest
+ * @retval Period mean (Q8.8 degC); 0 if index >= count
+ */
+Temp_t TempHistory_Get(const TempHistory_t *hist, uint8_t index)
+{
+    if (index >= hist->count)
+    {
+        return 0;
+    }
+    /* Oldest entry sits at head once the ring is full, at 0 before that */
+    uint8_t start = (hist->count < TEMP_HISTORY_LEN) ? 0 : hist->head;
+    return hist->ring[(start + index) % TEMP_HISTORY_LEN];
+}
@@ -0,0 +1,128 @@
+/**
+  ******************************************************************************
+  * @file    temp_trend.c
+  * @brief   Temperature trend: least-squares slope over a sliding window
+  * @details With k = 0..n-1 (oldest first) the index sums are closed form:
+  *            Sk  = n(n-1)/2,  Skk = (n-1)n(2n-1)/6
+  *            b   = (n*Sky - Sk*Sy) / (n*Skk - Sk^2)   [Q8.8 per sample]
+  *          Sliding the window by one sample re-indexes every y:
+  *            Sky' = Sky - (Sy - y_old) + (n-1)*y_new
+  *            Sy'  = Sy - y_old + y_new
+  *          so an update costs O(1) whatever the window length. The 64-bit
+  *          division runs once per sample; Slope/Predict read the result.
+  ******************************************************************************
+  */
+
+#include "temp_trend.h"
+
+#if (TEMP_TREND_WINDOW < 2) || (TEMP_TREND_WINDOW > 255)
+#error "TEMP_TREND_WINDOW must be in 2..255"
+#endif
+
+/* ========== Private Functions ========== */
+
+/**
+ * @brief Least-squares slope of the current window
+ * @param trend: Estimator instance
+ * @retval Slope in Q8.8 degC/min, 0 until at least 2 samples are available
+ */
+static Temp_t TempTrend_Fit(const TempTrend_t *trend)
+{
+    int32_t n = trend->count;
+
+    if (n < 2)
+    {
+        return 0;
+    }
+
+    uint8_t oldest = (n < TEMP_TREND_WINDOW) ? 0 : trend->head;
+    uint8_t newest = (trend->head + TEMP_TREND_WINDOW - 1) % TEMP_TREND_WINDOW;
+    uint32_t span = trend->times[newest] - trend->times[oldest];  /* ms over n-1 intervals */
+
+    if (span == 0)
+    {
+        return 0;
+    }
+
+    int32_t sumK = n * (n - 1) / 2;
+    int32_t sumKK = (n - 1) * n * (2 * n - 1) / 6;
+    int64_t num = (int64_t)n * trend->sumKY - (int64_t)sumK * trend->sumY;
+    int64_t den = (int64_t)n * sumKK - (int64_t)sumK * sumK;
+
+    /* per sample -> per minute: * 60000 ms / (span / (n-1)) */
+    int64_t slope = (num * 60000 * (n - 1)) / (den * (int64_t)span);
+
+    if (slope > INT16_MAX) slope = INT16_MAX;
+    if (slope < INT16_MIN) slope = INT16_MIN;
+    return (Temp_t)slope;
+}
+
+/* ========== Public Functions ========== */
+
+/**
+ * @brief Clear the window
+ * @param trend: Estimator instance
+ */
+void TempTrend_Init(TempTrend_t *trend)
+{
+    trend->head = 0;
+    trend->count = 0;
+    trend->sumY = 0;
+    trend->sumKY = 0;
+    trend->slope = 0;
+}
+
+/**
+ * @brief Add one (filtered) sample
+ * @param trend: Estimator instance
+ * @param sample: Sample with its timestamp
+ */
+void TempTrend_Update(TempTrend_t *trend, TempSample_t sample)
+{
+    if (trend->count < TEMP_TREND_WINDOW)
+    {
+        /* Filling: new sample gets the next index */
+        trend->sumKY += (int32_t)trend->count * sample.value;
+        trend->sumY += sample.value;
+        trend->count++;
+    }
+    else
+    {
+        /* Full: drop the oldest (at head), shift indices down by one */
+        Temp_t oldest = trend->window[trend->head];
+        trend->sumKY -= trend->sumY - oldest;
+        trend->sumY += sample.value - oldest;
+        trend->sumKY += (int32_t)(TEMP_TREND_WINDOW - 1) * sample.value;
+    }
+
+    trend->window[trend->head] = sample.value;
+    trend->times[trend->head] = sample.timestamp;
+    trend->head = (trend->head + 1) % TEMP_TREND_WINDOW;
+    trend->slope = TempTrend_Fit(trend);
+}
+
+/**
+ * @brief Current slope (cached, no division)
+ * @param trend: Estimator instance
+ * @retval Slope in Q8.8 degC/min, 0 until at least 2 samples are available
+ */
+Temp_t TempTrend_Slope(const TempTrend_t *trend)
+{
+    return trend->slope;
+}
+
+/**
+ * @brief Extrapolate a temperature along the current slope
+ * @param trend: Estimator instance
+ * @param current: Temperature now (Q8.8 degC)
+ * @param horizonS: Look-ahead in seconds
+ * @retval Predicted temperature (Q8.8 degC, saturated)
+ */
+Temp_t TempTrend_Predict(const TempTrend_t *trend, Temp_t current, uint16_t horizonS)
+{
+    int32_t predicted = current + (int32_t)trend->slope * horizonS / 60;
+
+    if (predicted > INT16_MAX) predicted = INT16_MAX;
+    if (predicted < INT16_MIN) predicted = INT16_MIN;
+    return (Temp_t)predicted;
+}
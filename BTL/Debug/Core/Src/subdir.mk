@@ -8,37 +8,67 @@ C_SRCS += \
 ../Core/Src/DS18B20.c \
 ../Core/Src/app_tasks.c \
 ../Core/Src/eeprom.c \
+../Core/Src/fixfmt.c \
 ../Core/Src/liquidcrystal_i2c.c \
+../Core/Src/lm75.c \
 ../Core/Src/main.c \
+../Core/Src/onewire_multi.c \
+../Core/Src/onewire_tim.c \
+../Core/Src/onewire_uart.c \
+../Core/Src/sensor.c \
+../Core/Src/sht3x.c \
 ../Core/Src/stm32f1xx_hal_msp.c \
 ../Core/Src/stm32f1xx_it.c \
 ../Core/Src/syscalls.c \
 ../Core/Src/sysmem.c \
-../Core/Src/system_stm32f1xx.c 
+../Core/Src/system_stm32f1xx.c \
+../Core/Src/temp_filter.c \
+../Core/Src/temp_history.c \
+../Core/Src/temp_trend.c 
 
 OBJS += \
 ./Core/Src/DS18B20.o \
 ./Core/Src/app_tasks.o \
 ./Core/Src/eeprom.o \
+./Core/Src/fixfmt.o \
 ./Core/Src/liquidcrystal_i2c.o \
+./Core/Src/lm75.o \
 ./Core/Src/main.o \
+./Core/Src/onewire_multi.o \
+./Core/Src/onewire_tim.o \
+./Core/Src/onewire_uart.o \
+./Core/Src/sensor.o \
+./Core/Src/sht3x.o \
 ./Core/Src/stm32f1xx_hal_msp.o \
 ./Core/Src/stm32f1xx_it.o \
 ./Core/Src/syscalls.o \
 ./Core/Src/sysmem.o \
-./Core/Src/system_stm32f1xx.o 
+./Core/Src/system_stm32f1xx.o \
+./Core/Src/temp_filter.o \
+./Core/Src/temp_history.o \
+./Core/Src/temp_trend.o 
 
 C_DEPS += \
 ./Core/Src/DS18B20.d \
 ./Core/Src/app_tasks.d \
 ./Core/Src/eeprom.d \
+./Core/Src/fixfmt.d \
 ./Core/Src/liquidcrystal_i2c.d \
+./Core/Src/lm75.d \
 ./Core/Src/main.d \
+./Core/Src/onewire_multi.d \
+./Core/Src/onewire_tim.d \
+./Core/Src/onewire_uart.d \
+./Core/Src/sensor.d \
+./Core/Src/sht3x.d \
 ./Core/Src/stm32f1xx_hal_msp.d \
 ./Core/Src/stm32f1xx_it.d \
 ./Core/Src/syscalls.d \
 ./Core/Src/sysmem.d \
-./Core/Src/system_stm32f1xx.d 
+./Core/Src/system_stm32f1xx.d \
+./Core/Src/temp_filter.d \
+./Core/Src/temp_history.d \
+./Core/Src/temp_trend.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
@@ -48,7 +78,7 @@ Core/Src/%.o Core/Src/%.su Core/Src/%.cyclo: ../Core/Src/%.c Core/Src/subdir.mk
 clean: clean-Core-2f-Src
 
 clean-Core-2f-Src:
-	-$(RM) ./Core/Src/DS18B20.cyclo ./Core/Src/DS18B20.d ./Core/Src/DS18B20.o ./Core/Src/DS18B20.su ./Core/Src/app_tasks.cyclo ./Core/Src/app_tasks.d ./Core/Src/app_tasks.o ./Core/Src/app_tasks.su ./Core/Src/eeprom.cyclo ./Core/Src/eeprom.d ./Core/Src/eeprom.o ./Core/Src/eeprom.su ./Core/Src/liquidcrystal_i2c.cyclo ./Core/Src/liquidcrystal_i2c.d ./Core/Src/liquidcrystal_i2c.o ./Core/Src/liquidcrystal_i2c.su ./Core/Src/main.cyclo ./Core/Src/main.d ./Core/Src/main.o ./Core/Src/main.su ./Core/Src/stm32f1xx_hal_msp.cyclo ./Core/Src/stm32f1xx_hal_msp.d ./Core/Src/stm32f1xx_hal_msp.o ./Core/Src/stm32f1xx_hal_msp.su ./Core/Src/stm32f1xx_it.cyclo ./Core/Src/stm32f1xx_it.d ./Core/Src/stm32f1xx_it.o ./Core/Src/stm32f1xx_it.su ./Core/Src/syscalls.cyclo ./Core/Src/syscalls.d ./Core/Src/syscalls.o ./Core/Src/syscalls.su ./Core/Src/sysmem.cyclo ./Core/Src/sysmem.d ./Core/Src/sysmem.o ./Core/Src/sysmem.su ./Core/Src/system_stm32f1xx.cyclo ./Core/Src/system_stm32f1xx.d ./Core/Src/system_stm32f1xx.o ./Core/Src/system_stm32f1xx.su
+	-$(RM) ./Core/Src/DS18B20.cyclo ./Core/Src/DS18B20.d ./Core/Src/DS18B20.o ./Core/Src/DS18B20.su ./Core/Src/app_tasks.cyclo ./Core/Src/app_tasks.d ./Core/Src/app_tasks.o ./Core/Src/app_tasks.su ./Core/Src/eeprom.cyclo ./Core/Src/eeprom.d ./Core/Src/eeprom.o ./Core/Src/eeprom.su ./Core/Src/fixfmt.cyclo ./Core/Src/fixfmt.d ./Core/Src/fixfmt.o ./Core/Src/fixfmt.su ./Core/Src/liquidcrystal_i2c.cyclo ./Core/Src/liquidcrystal_i2c.d ./Core/Src/liquidcrystal_i2c.o ./Core/Src/liquidcrystal_i2c.su ./Core/Src/lm75.cyclo ./Core/Src/lm75.d ./Core/Src/lm75.o ./Core/Src/lm75.su ./Core/Src/main.cyclo ./Core/Src/main.d ./Core/Src/main.o ./Core/Src/main.su ./Core/Src/onewire_multi.cyclo ./Core/Src/onewire_multi.d ./Core/Src/onewire_multi.o ./Core/Src/onewire_multi.su ./Core/Src/onewire_tim.cyclo ./Core/Src/onewire_tim.d ./Core/Src/onewire_tim.o ./Core/Src/onewire_tim.su ./Core/Src/onewire_uart.cyclo ./Core/Src/onewire_uart.d ./Core/Src/onewire_uart.o ./Core/Src/onewire_uart.su ./Core/Src/sensor.cyclo ./Core/Src/sensor.d ./Core/Src/sensor.o ./Core/Src/sensor.su ./Core/Src/sht3x.cyclo ./Core/Src/sht3x.d ./Core/Src/sht3x.o ./Core/Src/sht3x.su ./Core/Src/stm32f1xx_hal_msp.cyclo ./Core/Src/stm32f1xx_hal_msp.d ./Core/Src/stm32f1xx_hal_msp.o ./Core/Src/stm32f1xx_hal_msp.su ./Core/Src/stm32f1xx_it.cyclo ./Core/Src/stm32f1xx_it.d ./Core/Src/stm32f1xx_it.o ./Core/Src/stm32f1xx_it.su ./Core/Src/syscalls.cyclo ./Core/Src/syscalls.d ./Core/Src/syscalls.o ./Core/Src/syscalls.su ./Core/Src/sysmem.cyclo ./Core/Src/sysmem.d ./Core/Src/sysmem.o ./Core/Src/sysmem.su ./Core/Src/system_stm32f1xx.cyclo ./Core/Src/system_stm32f1xx.d ./Core/Src/system_stm32f1xx.o ./Core/Src/system_stm32f1xx.su ./Core/Src/temp_filter.cyclo ./Core/Src/temp_filter.d ./Core/Src/temp_filter.o ./Core/Src/temp_filter.su ./Core/Src/temp_history.cyclo ./Core/Src/temp_history.d ./Core/Src/temp_history.o ./Core/Src/temp_history.su ./Core/Src/temp_trend.cyclo ./Core/Src/temp_trend.d ./Core/Src/temp_trend.o ./Core/Src/temp_trend.su
 
 .PHONY: clean-Core-2f-Src
 
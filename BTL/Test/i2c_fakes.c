@@ -0,0 +1,115 @@
+/**
+  ******************************************************************************
+  * @file    i2c_fakes.c
+  * @brief   Fake LM75 and SHT3x devices for the stub I2C bus
+  ******************************************************************************
+  */
+
+#include "i2c_fakes.h"
+
+/* ========== LM75 ========== */
+
+static HAL_StatusTypeDef LM75_Write(void *ctx, const uint8_t *data, uint16_t size)
+{
+    FakeLM75_t *dev = (FakeLM75_t *)ctx;
+
+    if (size < 1)
+    {
+        return HAL_ERROR;
+    }
+    dev->pointer = data[0];
+    return HAL_OK;
+}
+
+static HAL_StatusTypeDef LM75_Read(void *ctx, uint8_t *data, uint16_t size)
+{
+    FakeLM75_t *dev = (FakeLM75_t *)ctx;
+    uint16_t reg = (dev->pointer == 0x00) ? ((uint16_t)dev->temp & 0xFF80) : 0xFFFF;
+
+    dev->reads++;
+    for (uint16_t i = 0; i < size; i++)
+    {
+        data[i] = (uint8_t)((i & 1) ? reg : reg >> 8);
+    }
+    return HAL_OK;
+}
+
+void FakeLM75_Attach(FakeLM75_t *dev, uint16_t addr)
+{
+    HAL_Stub_I2cDevice_t bus = { dev, LM75_Write, LM75_Read };
+
+    HAL_Stub_I2cAttach(addr, &bus);
+}
+
+/* ========== SHT3x ========== */
+
+/* Sensirion CRC8: poly 0x31, init 0xFF (independent of sht3x.c) */
+static uint8_t SHT3x_Crc(uint16_t word)
+{
+    uint8_t crc = 0xFF;
+
+    for (int8_t bit = 15; bit >= 0; bit--)
+    {
+        uint8_t in = (uint8_t)((word >> bit) & 1);
+        uint8_t top = (uint8_t)(crc >> 7);
+
+        crc = (uint8_t)(crc << 1);
+        if (in ^ top)
+        {
+            crc ^= 0x31;
+        }
+    }
+    return crc;
+}
+
+static HAL_StatusTypeDef SHT3x_Write(void *ctx, const uint8_t *data, uint16_t size)
+{
+    FakeSHT3x_t *dev = (FakeSHT3x_t *)ctx;
+
+    if (size != 2 || data[0] != 0x24 || data[1] != 0x00)
+    {
+        return HAL_ERROR;   /* Only single shot, high repeatability, no stretch */
+    }
+    dev->commands++;
+    dev->measuring = 1;
+    dev->readyNs = HAL_Stub_TimeNs + FAKE_SHT3X_MEASURE_NS;
+    return HAL_OK;
+}
+
+static HAL_StatusTypeDef SHT3x_Read(void *ctx, uint8_t *data, uint16_t size)
+{
+    FakeSHT3x_t *dev = (FakeSHT3x_t *)ctx;
+    uint8_t frame[6];
+
+    if (!dev->measuring || HAL_Stub_TimeNs < dev->readyNs)
+    {
+        dev->nacks++;
+        return HAL_ERROR;   /* No clock stretching: read header is NACKed */
+    }
+    dev->measuring = 0;
+    frame[0] = (uint8_t)(dev->rawT >> 8);
+    frame[1] = (uint8_t)dev->rawT;
+    frame[2] = (uint8_t)(SHT3x_Crc(dev->rawT) ^ (dev->corruptCrc ? 0x01 : 0x00));
+    frame[3] = (uint8_t)(dev->rawRH >> 8);
+    frame[4] = (uint8_t)dev->rawRH;
+    frame[5] = SHT3x_Crc(dev->rawRH);
+    for (uint16_t i = 0; i < size && i < sizeof(frame); i++)
+    {
+        data[i] = frame[i];
+    }
+    return HAL_OK;
+}
+
+void FakeSHT3x_Attach(FakeSHT3x_t *dev, uint16_t addr)
+{
+    HAL_Stub_I2cDevice_t bus = { dev, SHT3x_Write, SHT3x_Read };
+
+    HAL_Stub_I2cAttach(addr, &bus);
+}
+
+void FakeSHT3x_Set(FakeSHT3x_t *dev, int32_t centiC, uint32_t centiRH)
+{
+    /* Inverse of T = -45 + 175 * raw / 65535, RH = 100 * raw / 65535 */
+    dev->rawT = (uint16_t)(((int64_t)(centiC + 4500) * 65535 + 8750) / 17500);
+    dev->rawRH = (uint16_t)(((uint64_t)centiRH * 65535 + 5000) / 10000);
+}
@@ -0,0 +1,52 @@
+/**
+  ******************************************************************************
+  * @file    i2c_fakes.h
+  * @brief   Fake LM75 and SHT3x devices for the stub I2C bus
+  * @details Register-level behaviour only: the LM75 answers a pointer write
+  *          and a 2-byte temperature read; the SHT3x takes the single-shot
+  *          measure command, NACKs reads until the conversion is done and
+  *          returns T/RH words with Sensirion CRCs.
+  ******************************************************************************
+  */
+
+#ifndef I2C_FAKES_H_
+#define I2C_FAKES_H_
+
+#include "stm32f1xx_hal.h"
+
+/* ========== Fake Configuration ========== */
+#define FAKE_SHT3X_MEASURE_NS   12500000ULL     /* Datasheet typical 12.5 ms */
+
+/* ========== Data Types ========== */
+typedef struct {
+    int16_t temp;           /* Q8.8 degC, register keeps 9 bits */
+    uint8_t pointer;        /* Last register pointer written */
+    uint32_t reads;
+} FakeLM75_t;
+
+typedef struct {
+    uint16_t rawT;
+    uint16_t rawRH;
+    uint8_t corruptCrc;     /* 1: flip a bit in the T CRC */
+    uint8_t measuring;
+    uint64_t readyNs;       /* HAL_Stub_TimeNs when the result is available */
+    uint32_t commands;
+    uint32_t nacks;         /* Reads refused because no result was ready */
+} FakeSHT3x_t;
+
+/* ========== Function Prototypes ========== */
+
+/** @brief Put an LM75 on the stub bus at a HAL 8-bit address */
+void FakeLM75_Attach(FakeLM75_t *dev, uint16_t addr);
+
+/** @brief Put an SHT3x on the stub bus at a HAL 8-bit address */
+void FakeSHT3x_Attach(FakeSHT3x_t *dev, uint16_t addr);
+
+/**
+ * @brief Set the SHT3x reading from physical values
+ * @param centiC: Temperature in 0.01 degC (-45.00..130.00)
+ * @param centiRH: Relative humidity in 0.01 % (0..100.00)
+ */
+void FakeSHT3x_Set(FakeSHT3x_t *dev, int32_t centiC, uint32_t centiRH);
+
+#endif /* I2C_FAKES_H_ */
@@ -0,0 +1,804 @@
+/**
+  ******************************************************************************
+  * @file    onewire_sim.c
+  * @brief   Host 1-Wire bus simulator: PHY hooks, DS18B20 models, margins
+  * @details The bus is open drain: the line is low while the master or any
+  *          device pulls it. Devices react to master edges only:
+  *          - master low >= 480 us: reset, every device answers presence
+  *            30 us after the release and holds it for 120 us;
+  *          - shorter lows are time slots. On the falling edge a device that
+  *            transmits a 0 holds the line for 30 us; on the release the
+  *            device decodes the master bit (low < 15 us = 1, >= 60 us = 0,
+  *            anything in between is counted in slotErrors).
+  *          Each GPIOB pin is a separate bus segment. The DS18B20_Phy* hooks
+  *          drive the DS18B20_PIN segment, the OneWire_Multi_Phy* hooks drive
+  *          every pin named in a BSRR word at once. Only the DS18B20_PIN
+  *          segment is recorded in the waveform.
+  ******************************************************************************
+  */
+
+#include "onewire_sim.h"
+#include "DS18B20.h"
+#include "onewire_multi.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define US(x)               ((uint64_t)(x) * 1000ULL)
+#define OWSIM_RESET_MIN_NS  US(480)
+#define OWSIM_RESET_GUESS   US(400)    /* Margin check: longer lows are resets */
+#define OWSIM_NO_LIMIT      UINT32_MAX
+#define OWSIM_IDLE_NS       US(1000)   /* Longer gaps are bus idle, not slot time */
+#define DQ_SEGMENT          ((uint8_t)(31U - __CLZ(DS18B20_PIN)))
+
+/* ========== Device Protocol State ========== */
+typedef enum {
+    OWD_IDLE = 0,       /* Not selected, waits for a reset */
+    OWD_ROM_CMD,
+    OWD_READ_ROM,
+    OWD_MATCH_ROM,
+    OWD_SEARCH,
+    OWD_FUNC_CMD,
+    OWD_CONVERT,        /* Read slots return 0 while converting */
+    OWD_READ_SP,
+    OWD_WRITE_SP,
+    OWD_READ_POWER
+} OwdState_t;
+
+typedef struct {
+    OwdState_t state;
+    uint16_t bitIdx;
+    uint8_t shift;
+    uint8_t searchStep;     /* 0: bit, 1: complement, 2: direction from master */
+    uint8_t converting;
+    uint8_t powerFail;      /* Parasite device lost power during conversion */
+    uint64_t convDoneNs;
+    uint64_t lowFromNs;     /* Device pulls the line in [lowFrom, lowUntil) */
+    uint64_t lowUntilNs;
+} OwdProto_t;
+
+/* Master side of one segment */
+typedef struct {
+    uint8_t low;
+    uint64_t fallNs;
+} OwSimMaster_t;
+
+static OwSimDevice_t devices[OWSIM_MAX_DEVICES];
+static OwdProto_t proto[OWSIM_MAX_DEVICES];
+static uint8_t deviceCount;
+static OwSimMaster_t master[OWSIM_SEGMENTS];
+
+static OwSimEvent_t events[OWSIM_MAX_EVENTS];
+static uint32_t eventCount;
+
+static uint32_t phyOverheadNs;
+static uint8_t busShorted;
+static uint64_t lastEdgeNs;
+
+/* ========== Helpers ========== */
+
+uint8_t OneWireSim_Crc8(const uint8_t *data, uint8_t length)
+{
+    uint8_t crc = 0;
+
+    while (length--)
+    {
+        uint8_t b = *data++;
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            uint8_t mix = (crc ^ b) & 0x01;
+            crc >>= 1;
+            if (mix)
+            {
+                crc ^= 0x8C;
+            }
+            b >>= 1;
+        }
+    }
+    return crc;
+}
+
+static void Record(uint8_t seg, uint64_t t, OwSimEventType_t type, uint8_t value)
+{
+    if (seg == DQ_SEGMENT && eventCount < OWSIM_MAX_EVENTS)
+    {
+        events[eventCount].t = t;
+        events[eventCount].type = type;
+        events[eventCount].value = value;
+        eventCount++;
+    }
+}
+
+static uint8_t BitOf(const uint8_t *bytes, uint16_t idx)
+{
+    return (bytes[idx >> 3] >> (idx & 7)) & 0x01;
+}
+
+static void DevPullLow(uint8_t i, uint64_t from, uint64_t until)
+{
+    proto[i].lowFromNs = from;
+    proto[i].lowUntilNs = until;
+    Record(devices[i].segment, from, OWSIM_EV_DEVICE_LOW, 0);
+    Record(devices[i].segment, until, OWSIM_EV_DEVICE_RELEASE, 0);
+}
+
+/** @brief Device i is plugged in on segment seg */
+static uint8_t OnSegment(uint8_t i, uint8_t seg)
+{
+    return devices[i].present && devices[i].segment == seg;
+}
+
+static uint8_t LineLevel(uint8_t seg, uint64_t now)
+{
+    if (master[seg].low || (busShorted && seg == DQ_SEGMENT))
+    {
+        return 0;
+    }
+    for (uint8_t i = 0; i < deviceCount; i++)
+    {
+        if (OnSegment(i, seg) && now >= proto[i].lowFromNs && now < proto[i].lowUntilNs)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* ========== DS18B20 Model ========== */
+
+static void DevScratchpadCrc(OwSimDevice_t *d)
+{
+    d->scratchpad[8] = OneWireSim_Crc8(d->scratchpad, 8);
+}
+
+/** @brief Finish a conversion whose time has elapsed */
+static void DevUpdate(uint8_t i, uint64_t now)
+{
+    OwSimDevice_t *d = &devices[i];
+    OwdProto_t *p = &proto[i];
+    int8_t whole;
+
+    if (!p->converting || now < p->convDoneNs)
+    {
+        return;
+    }
+    p->converting = 0;
+    if (p->powerFail)
+    {
+        return;     /* Scratchpad keeps the previous result */
+    }
+    d->scratchpad[0] = (uint8_t)d->tempQ4;
+    d->scratchpad[1] = (uint8_t)((uint16_t)d->tempQ4 >> 8);
+    d->scratchpad[6] = (uint8_t)(0x10 - (d->tempQ4 & 0x0F));   /* COUNT_REMAIN */
+    DevScratchpadCrc(d);
+    whole = (int8_t)(d->tempQ4 >> 4);
+    d->alarm = (whole <= (int8_t)d->scratchpad[3]) || (whole >= (int8_t)d->scratchpad[2]);
+    d->conversions++;
+}
+
+static int8_t DevTxBit(uint8_t i)
+{
+    OwSimDevice_t *d = &devices[i];
+    OwdProto_t *p = &proto[i];
+
+    switch (p->state)
+    {
+    case OWD_READ_ROM:
+        return (p->bitIdx < 64) ? BitOf(d->rom, p->bitIdx) : 1;
+    case OWD_SEARCH:
+        if (p->searchStep == 0)
+        {
+            return BitOf(d->rom, p->bitIdx);
+        }
+        if (p->searchStep == 1)
+        {
+            return !BitOf(d->rom, p->bitIdx);
+        }
+        return -1;
+    case OWD_CONVERT:
+        return d->parasite ? 1 : !p->converting;
+    case OWD_READ_SP:
+        return (p->bitIdx < 72) ? BitOf(d->scratchpad, p->bitIdx) : 1;
+    case OWD_READ_POWER:
+        return !d->parasite;
+    default:
+        return -1;
+    }
+}
+
+static void DevReset(uint8_t i, uint64_t now)
+{
+    OwdProto_t *p = &proto[i];
+
+    p->state = OWD_ROM_CMD;
+    p->bitIdx = 0;
+    p->shift = 0;
+    p->searchStep = 0;
+    DevPullLow(i, now + OWSIM_PRESENCE_WAIT_NS, now + OWSIM_PRESENCE_WAIT_NS + OWSIM_PRESENCE_LOW_NS);
+}
+
+static void DevSlotBegin(uint8_t i, uint64_t now)
+{
+    OwSimDevice_t *d = &devices[i];
+    OwdProto_t *p = &proto[i];
+
+    DevUpdate(i, now);
+    if (d->parasite && p->converting)
+    {
+        p->powerFail = 1;   /* Any low during conversion starves the device */
+    }
+    if (DevTxBit(i) == 0)
+    {
+        DevPullLow(i, now, now + OWSIM_TX0_LOW_NS);
+    }
+}
+
+/** @brief Shift one received bit in; returns 1 when a full byte is ready */
+static uint8_t DevRxBit(OwdProto_t *p, uint8_t bit)
+{
+    p->shift = (uint8_t)((p->shift >> 1) | (bit ? 0x80 : 0x00));
+    p->bitIdx++;
+    return (p->bitIdx & 7) == 0;
+}
+
+static void DevFunction(uint8_t i, uint8_t cmd, uint64_t now)
+{
+    OwdProto_t *p = &proto[i];
+
+    p->bitIdx = 0;
+    switch (cmd)
+    {
+    case 0x44:
+        p->state = OWD_CONVERT;
+        p->converting = !devices[i].frozen;
+        p->powerFail = 0;
+        p->convDoneNs = now + OWSIM_CONV_NS;
+        break;
+    case 0xBE:
+        p->state = OWD_READ_SP;
+        break;
+    case 0x4E:
+        p->state = OWD_WRITE_SP;
+        break;
+    case 0xB4:
+        p->state = OWD_READ_POWER;
+        break;
+    default:        /* 0x48 Copy / 0xB8 Recall: nothing to model */
+        p->state = OWD_IDLE;
+        break;
+    }
+}
+
+static void DevSlotEnd(uint8_t i, uint64_t lowNs, uint64_t now)
+{
+    OwSimDevice_t *d = &devices[i];
+    OwdProto_t *p = &proto[i];
+    uint8_t bit;
+
+    if (lowNs < US(15))
+    {
+        bit = 1;
+    }
+    else if (lowNs >= US(60))
+    {
+        bit = 0;
+    }
+    else
+    {
+        d->slotErrors++;
+        bit = lowNs < OWSIM_TX0_LOW_NS;     /* What a device sampling at 30 us sees */
+    }
+
+    switch (p->state)
+    {
+    case OWD_ROM_CMD:
+        if (DevRxBit(p, bit))
+        {
+            uint8_t cmd = p->shift;
+            p->bitIdx = 0;
+            p->searchStep = 0;
+            if (cmd == 0x33)
+            {
+                p->state = OWD_READ_ROM;
+            }
+            else if (cmd == 0x55)
+            {
+                p->state = OWD_MATCH_ROM;
+            }
+            else if (cmd == 0xCC)
+            {
+                p->state = OWD_FUNC_CMD;
+            }
+            else if (cmd == 0xF0 || (cmd == 0xEC && d->alarm))
+            {
+                p->state = OWD_SEARCH;
+            }
+            else
+            {
+                p->state = OWD_IDLE;
+            }
+        }
+        break;
+    case OWD_READ_ROM:
+        if (++p->bitIdx == 64)
+        {
+            p->bitIdx = 0;
+            p->state = OWD_FUNC_CMD;
+        }
+        break;
+    case OWD_MATCH_ROM:
+        if (bit != BitOf(d->rom, p->bitIdx))
+        {
+            p->state = OWD_IDLE;
+        }
+        else if (++p->bitIdx == 64)
+        {
+            p->bitIdx = 0;
+            p->state = OWD_FUNC_CMD;
+        }
+        break;
+    case OWD_SEARCH:
+        if (p->searchStep < 2)
+        {
+            p->searchStep++;
+        }
+        else if (bit != BitOf(d->rom, p->bitIdx))
+        {
+            p->state = OWD_IDLE;
+        }
+        else
+        {
+            p->searchStep = 0;
+            if (++p->bitIdx == 64)
+            {
+                p->bitIdx = 0;
+                p->state = OWD_FUNC_CMD;
+            }
+        }
+        break;
+    case OWD_FUNC_CMD:
+        if (DevRxBit(p, bit))
+        {
+            DevFunction(i, p->shift, now);
+        }
+        break;
+    case OWD_READ_SP:
+        p->bitIdx++;
+        break;
+    case OWD_WRITE_SP:
+        if (DevRxBit(p, bit))
+        {
+            uint8_t n = (uint8_t)(p->bitIdx / 8);   /* 1..3: TH, TL, config */
+            if (n == 3)
+            {
+                d->scratchpad[4] = (uint8_t)((p->shift & 0x60) | 0x1F);
+                DevScratchpadCrc(d);
+                p->state = OWD_IDLE;
+            }
+            else
+            {
+                d->scratchpad[1 + n] = p->shift;
+                DevScratchpadCrc(d);
+            }
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/* ========== Segment Edges ========== */
+
+static void SegLow(uint8_t seg, uint64_t now)
+{
+    if (master[seg].low)
+    {
+        return;
+    }
+    Record(seg, now, OWSIM_EV_MASTER_LOW, 0);
+    master[seg].low = 1;
+    master[seg].fallNs = now;
+    lastEdgeNs = now;
+    for (uint8_t i = 0; i < deviceCount; i++)
+    {
+        if (OnSegment(i, seg))
+        {
+            DevSlotBegin(i, now);
+        }
+    }
+}
+
+static void SegRelease(uint8_t seg, uint64_t now)
+{
+    uint64_t low;
+
+    if (!master[seg].low)
+    {
+        return;
+    }
+    Record(seg, now, OWSIM_EV_MASTER_RELEASE, 0);
+    master[seg].low = 0;
+    lastEdgeNs = now;
+    low = now - master[seg].fallNs;
+    for (uint8_t i = 0; i < deviceCount; i++)
+    {
+        if (!OnSegment(i, seg))
+        {
+            continue;
+        }
+        if (low >= OWSIM_RESET_MIN_NS)
+        {
+            DevReset(i, now);
+        }
+        else
+        {
+            DevSlotEnd(i, low, now);
+        }
+    }
+}
+
+static uint8_t SegSample(uint8_t seg, uint64_t now)
+{
+    uint8_t level = LineLevel(seg, now);
+
+    Record(seg, now, OWSIM_EV_SAMPLE, level);
+    return level;
+}
+
+static void UpdateAll(uint64_t now)
+{
+    for (uint8_t i = 0; i < deviceCount; i++)
+    {
+        DevUpdate(i, now);
+    }
+}
+
+/* ========== PHY Hooks (DS18B20_PHY_EXTERNAL) ========== */
+
+void DS18B20_PhyLow(void)
+{
+    HAL_Stub_TimeNs += phyOverheadNs;
+    SegLow(DQ_SEGMENT, HAL_Stub_TimeNs);
+}
+
+void DS18B20_PhyRelease(void)
+{
+    HAL_Stub_TimeNs += phyOverheadNs;
+    SegRelease(DQ_SEGMENT, HAL_Stub_TimeNs);
+}
+
+uint8_t DS18B20_PhySample(void)
+{
+    HAL_Stub_TimeNs += phyOverheadNs;
+    UpdateAll(HAL_Stub_TimeNs);
+    return SegSample(DQ_SEGMENT, HAL_Stub_TimeNs);
+}
+
+void DS18B20_PhyDelayUs(uint32_t us)
+{
+    HAL_Stub_TimeNs += US(us) + phyOverheadNs;
+}
+
+/* ========== PHY Hooks (ONEWIRE_MULTI_PHY_EXTERNAL) ========== */
+
+void OneWire_Multi_PhyDrive(uint32_t bsrr)
+{
+    HAL_Stub_TimeNs += phyOverheadNs;
+    for (uint8_t seg = 0; seg < OWSIM_SEGMENTS; seg++)
+    {
+        if (bsrr & (1UL << seg))
+        {
+            SegRelease(seg, HAL_Stub_TimeNs);   /* BSx wins over BRx, as on the STM32 */
+        }
+        else if (bsrr & (1UL << (seg + 16)))
+        {
+            SegLow(seg, HAL_Stub_TimeNs);
+        }
+    }
+}
+
+uint16_t OneWire_Multi_PhySample(void)
+{
+    uint16_t idr = 0;
+
+    HAL_Stub_TimeNs += phyOverheadNs;
+    UpdateAll(HAL_Stub_TimeNs);
+    for (uint8_t seg = 0; seg < OWSIM_SEGMENTS; seg++)
+    {
+        if (SegSample(seg, HAL_Stub_TimeNs))
+        {
+            idr |= (uint16_t)(1U << seg);
+        }
+    }
+    return idr;
+}
+
+void OneWire_Multi_PhyDelayUs(uint32_t us)
+{
+    HAL_Stub_TimeNs += US(us) + phyOverheadNs;
+}
+
+/* ========== Public Functions ========== */
+
+void OneWireSim_Init(uint32_t overheadNs)
+{
+    memset(devices, 0, sizeof(devices));
+    memset(proto, 0, sizeof(proto));
+    deviceCount = 0;
+    eventCount = 0;
+    phyOverheadNs = overheadNs;
+    busShorted = 0;
+    memset(master, 0, sizeof(master));
+    lastEdgeNs = 0;
+}
+
+OwSimDevice_t *OneWireSim_AddDevice(uint64_t serial, int16_t tempQ4, uint8_t parasite)
+{
+    return OneWireSim_AddSegmentDevice(DQ_SEGMENT, serial, tempQ4, parasite);
+}
+
+OwSimDevice_t *OneWireSim_AddSegmentDevice(uint8_t segment, uint64_t serial, int16_t tempQ4, uint8_t parasite)
+{
+    static const uint8_t powerOn[8] = { 0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10 };
+    OwSimDevice_t *d;
+
+    if (deviceCount >= OWSIM_MAX_DEVICES || segment >= OWSIM_SEGMENTS)
+    {
+        return NULL;
+    }
+    d = &devices[deviceCount];
+    d->rom[0] = 0x28;
+    for (uint8_t i = 0; i < 6; i++)
+    {
+        d->rom[1 + i] = (uint8_t)(serial >> (8 * i));
+    }
+    d->rom[7] = OneWireSim_Crc8(d->rom, 7);
+    memcpy(d->scratchpad, powerOn, sizeof(powerOn));
+    DevScratchpadCrc(d);
+    d->tempQ4 = tempQ4;
+    d->parasite = parasite;
+    d->present = 1;
+    d->segment = segment;
+    proto[deviceCount].state = OWD_IDLE;
+    deviceCount++;
+    return d;
+}
+
+void OneWireSim_ShortBus(uint8_t shorted)
+{
+    busShorted = shorted;
+}
+
+void OneWireSim_ClearWaveform(void)
+{
+    eventCount = 0;
+}
+
+const OwSimEvent_t *OneWireSim_Waveform(uint32_t *count)
+{
+    *count = eventCount;
+    return events;
+}
+
+uint64_t OneWireSim_LastEdgeNs(void)
+{
+    return lastEdgeNs;
+}
+
+/* ========== Margin Check ========== */
+
+static void MarginSet(OwSimReport_t *r, OwSimTiming_t t, const char *name,
+                      uint32_t nominalUs, uint32_t minNs, uint32_t maxNs)
+{
+    r->t[t].name = name;
+    r->t[t].nominalNs = nominalUs * 1000U;
+    r->t[t].limitMinNs = minNs;
+    r->t[t].limitMaxNs = maxNs;
+    r->t[t].count = 0;
+    r->t[t].minNs = UINT32_MAX;
+    r->t[t].maxNs = 0;
+    r->t[t].violations = 0;
+}
+
+static void MarginAdd(OwSimReport_t *r, OwSimTiming_t t, uint64_t ns)
+{
+    OwSimMargin_t *m = &r->t[t];
+    uint32_t v = (ns > UINT32_MAX) ? UINT32_MAX : (uint32_t)ns;
+
+    m->count++;
+    if (v < m->minNs)
+    {
+        m->minNs = v;
+    }
+    if (v > m->maxNs)
+    {
+        m->maxNs = v;
+    }
+    if (v < m->limitMinNs || v > m->limitMaxNs)
+    {
+        m->violations++;
+        r->violations++;
+    }
+}
+
+/** @brief Index of the next master edge of the given type at or after i */
+static uint32_t NextMaster(uint32_t i, OwSimEventType_t type)
+{
+    while (i < eventCount && events[i].type != type)
+    {
+        i++;
+    }
+    return i;
+}
+
+void OneWireSim_Margins(OwSimReport_t *report)
+{
+    OwSimReport_t *r = report;
+
+    MarginSet(r, OWSIM_T_RESET_LOW, "reset low", DS18B20_T_RSTL_US, 480000, 960000);
+    MarginSet(r, OWSIM_T_PRESENCE_SAMPLE, "presence sample", DS18B20_T_PRESENCE_US, 60000, 75000);
+    MarginSet(r, OWSIM_T_RESET_HIGH, "reset high", DS18B20_T_PRESENCE_US + DS18B20_T_RSTH_US, 480000, OWSIM_NO_LIMIT);
+    MarginSet(r, OWSIM_T_WRITE1_LOW, "write-1 low", DS18B20_T_LOW1_US, 1000, 15000);
+    MarginSet(r, OWSIM_T_WRITE0_LOW, "write-0 low", DS18B20_T_LOW0_US, 60000, 120000);
+    MarginSet(r, OWSIM_T_READ_LOW, "read low", DS18B20_T_RDLOW_US, 1000, 15000);
+    MarginSet(r, OWSIM_T_READ_SAMPLE, "read sample", DS18B20_T_RDLOW_US + DS18B20_T_RDV_US, 1000, 15000);
+    MarginSet(r, OWSIM_T_SLOT, "slot", DS18B20_T_SLOT_US, 60000, OWSIM_NO_LIMIT);
+    MarginSet(r, OWSIM_T_RECOVERY, "recovery", DS18B20_T_REC_US, 1000, OWSIM_NO_LIMIT);
+    r->violations = 0;
+
+    for (uint32_t i = NextMaster(0, OWSIM_EV_MASTER_LOW); i < eventCount;)
+    {
+        uint32_t rel = NextMaster(i + 1, OWSIM_EV_MASTER_RELEASE);
+        uint32_t next;
+        uint64_t t0 = events[i].t, t1, low;
+        uint8_t sampled = 0;
+        uint64_t ts = 0;
+
+        if (rel >= eventCount)
+        {
+            break;
+        }
+        t1 = events[rel].t;
+        low = t1 - t0;
+        next = NextMaster(rel + 1, OWSIM_EV_MASTER_LOW);
+        for (uint32_t k = i + 1; k < next; k++)
+        {
+            if (events[k].type == OWSIM_EV_SAMPLE)
+            {
+                ts = events[k].t;
+                sampled = 1;
+                break;
+            }
+        }
+
+        if (low >= OWSIM_RESET_GUESS)
+        {
+            MarginAdd(r, OWSIM_T_RESET_LOW, low);
+            if (sampled)
+            {
+                MarginAdd(r, OWSIM_T_PRESENCE_SAMPLE, ts - t1);
+            }
+            if (next < eventCount)
+            {
+                MarginAdd(r, OWSIM_T_RESET_HIGH, events[next].t - t1);
+            }
+        }
+        else
+        {
+            if (sampled)
+            {
+                MarginAdd(r, OWSIM_T_READ_LOW, low);
+                MarginAdd(r, OWSIM_T_READ_SAMPLE, ts - t0);
+            }
+            else
+            {
+                MarginAdd(r, (low < US(15)) ? OWSIM_T_WRITE1_LOW : OWSIM_T_WRITE0_LOW, low);
+            }
+            if (next < eventCount && events[next].t - t1 < OWSIM_IDLE_NS)
+            {
+                MarginAdd(r, OWSIM_T_SLOT, events[next].t - t0);
+                MarginAdd(r, OWSIM_T_RECOVERY, events[next].t - t1);
+            }
+        }
+        i = next;
+    }
+}
+
+void OneWireSim_PrintReport(FILE *out, const OwSimReport_t *report)
+{
+    fprintf(out, "%-16s %8s %17s %9s %9s %9s %6s %4s\n",
+            "parameter", "nominal", "datasheet (us)", "min", "max", "margin", "count", "viol");
+    for (uint8_t t = 0; t < OWSIM_T_COUNT; t++)
+    {
+        const OwSimMargin_t *m = &report->t[t];
+        char limit[24];
+        double margin;
+
+        if (m->limitMaxNs == OWSIM_NO_LIMIT)
+        {
+            snprintf(limit, sizeof(limit), ">= %.1f", m->limitMinNs / 1000.0);
+        }
+        else
+        {
+            snprintf(limit, sizeof(limit), "%.1f..%.1f", m->limitMinNs / 1000.0, m->limitMaxNs / 1000.0);
+        }
+        if (m->count == 0)
+        {
+            fprintf(out, "%-16s %8.1f %17s %9s %9s %9s %6u %4u\n",
+                    m->name, m->nominalNs / 1000.0, limit, "-", "-", "-", 0U, 0U);
+            continue;
+        }
+        margin = ((double)m->minNs - m->limitMinNs) / 1000.0;
+        if (m->limitMaxNs != OWSIM_NO_LIMIT && ((double)m->limitMaxNs - m->maxNs) / 1000.0 < margin)
+        {
+            margin = ((double)m->limitMaxNs - m->maxNs) / 1000.0;
+        }
+        fprintf(out, "%-16s %8.1f %17s %9.3f %9.3f %9.3f %6u %4u\n",
+                m->name, m->nominalNs / 1000.0, limit, m->minNs / 1000.0, m->maxNs / 1000.0,
+                margin, m->count, m->violations);
+    }
+}
+
+/* ========== VCD Dump ========== */
+
+static int EventCompare(const void *a, const void *b)
+{
+    const OwSimEvent_t *ea = *(const OwSimEvent_t * const *)a;
+    const OwSimEvent_t *eb = *(const OwSimEvent_t * const *)b;
+
+    if (ea->t != eb->t)
+    {
+        return (ea->t < eb->t) ? -1 : 1;
+    }
+    return (ea < eb) ? -1 : (ea > eb);
+}
+
+int OneWireSim_DumpVcd(const char *path)
+{
+    const OwSimEvent_t **order;
+    FILE *f = fopen(path, "w");
+    uint8_t mLow = 0;
+    int devLow = 0;
+    uint64_t last = 0;
+
+    if (f == NULL)
+    {
+        return -1;
+    }
+    order = malloc(eventCount * sizeof(*order) + 1);
+    if (order == NULL)
+    {
+        fclose(f);
+        return -1;
+    }
+    for (uint32_t i = 0; i < eventCount; i++)
+    {
+        order[i] = &events[i];
+    }
+    qsort(order, eventCount, sizeof(*order), EventCompare);
+
+    fprintf(f, "$timescale 1ns $end\n$scope module onewire $end\n");
+    fprintf(f, "$var wire 1 m master $end\n$var wire 1 d dq $end\n$var wire 1 s sample $end\n");
+    fprintf(f, "$upscope $end\n$enddefinitions $end\n#0\n1m\n1d\nxs\n");
+    for (uint32_t i = 0; i < eventCount; i++)
+    {
+        const OwSimEvent_t *e = order[i];
+
+        if (e->t != last)
+        {
+            fprintf(f, "#%llu\n", (unsigned long long)e->t);
+            last = e->t;
+        }
+        switch (e->type)
+        {
+        case OWSIM_EV_MASTER_LOW:       mLow = 1; break;
+        case OWSIM_EV_MASTER_RELEASE:   mLow = 0; break;
+        case OWSIM_EV_DEVICE_LOW:       devLow++; break;
+        case OWSIM_EV_DEVICE_RELEASE:   devLow--; break;
+        case OWSIM_EV_SAMPLE:           fprintf(f, "%us\n", e->value); break;
+        }
+        fprintf(f, "%um\n%ud\n", mLow ? 0U : 1U, (mLow || devLow > 0) ? 0U : 1U);
+    }
+    free(order);
+    fclose(f);
+    return 0;
+}
@@ -0,0 +1,151 @@
+/**
+  ******************************************************************************
+  * @file    onewire_sim.h
+  * @brief   Host 1-Wire bus simulator for DS18B20.c built with
+  *          -DDS18B20_PHY_EXTERNAL
+  * @details Implements the DS18B20_Phy* hooks on simulated time, records
+  *          every master edge and sample as a timestamped waveform, and
+  *          runs behavioural DS18B20 models on the bus (reset/presence, ROM
+  *          commands, scratchpad, conversion, alarm flag, parasite power).
+  *          OneWireSim_Margins() measures the recorded waveform against the
+  *          datasheet slot limits. The OneWire_Multi_Phy* hooks of
+  *          onewire_multi.c (-DONEWIRE_MULTI_PHY_EXTERNAL) drive the other
+  *          GPIOB pins as independent segments with their own devices.
+  ******************************************************************************
+  */
+
+#ifndef ONEWIRE_SIM_H_
+#define ONEWIRE_SIM_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* ========== Simulator Configuration ========== */
+#define OWSIM_MAX_DEVICES       8
+#define OWSIM_SEGMENTS          16          /* One bus per GPIOB pin */
+#define OWSIM_MAX_EVENTS        65536
+#define OWSIM_PRESENCE_WAIT_NS  30000ULL    /* t_PDHIGH: 15..60 us */
+#define OWSIM_PRESENCE_LOW_NS   120000ULL   /* t_PDLOW: 60..240 us */
+#define OWSIM_TX0_LOW_NS        30000ULL    /* Device holds a 0 for 15..60 us */
+#define OWSIM_CONV_NS           750000000ULL
+
+/* ========== Data Types ========== */
+typedef enum {
+    OWSIM_EV_MASTER_LOW = 0,
+    OWSIM_EV_MASTER_RELEASE,
+    OWSIM_EV_DEVICE_LOW,
+    OWSIM_EV_DEVICE_RELEASE,
+    OWSIM_EV_SAMPLE
+} OwSimEventType_t;
+
+typedef struct {
+    uint64_t t;             /* ns */
+    OwSimEventType_t type;
+    uint8_t value;          /* SAMPLE: level read by the master */
+} OwSimEvent_t;
+
+/* Timing parameters checked by OneWireSim_Margins() */
+typedef enum {
+    OWSIM_T_RESET_LOW = 0,
+    OWSIM_T_PRESENCE_SAMPLE,
+    OWSIM_T_RESET_HIGH,
+    OWSIM_T_WRITE1_LOW,
+    OWSIM_T_WRITE0_LOW,
+    OWSIM_T_READ_LOW,
+    OWSIM_T_READ_SAMPLE,
+    OWSIM_T_SLOT,
+    OWSIM_T_RECOVERY,
+    OWSIM_T_COUNT
+} OwSimTiming_t;
+
+typedef struct {
+    const char *name;
+    uint32_t nominalNs;     /* From the DS18B20_T_* constants */
+    uint32_t limitMinNs;    /* Datasheet */
+    uint32_t limitMaxNs;    /* Datasheet, UINT32_MAX = none */
+    uint32_t count;
+    uint32_t minNs;
+    uint32_t maxNs;
+    uint32_t violations;
+} OwSimMargin_t;
+
+typedef struct {
+    OwSimMargin_t t[OWSIM_T_COUNT];
+    uint32_t violations;    /* Sum over all parameters */
+} OwSimReport_t;
+
+/* One DS18B20 on the bus */
+typedef struct {
+    uint8_t rom[8];
+    uint8_t scratchpad[9];
+    int16_t tempQ4;         /* Temperature the next conversion latches (1/16 degC) */
+    uint8_t parasite;       /* 1: powered from DQ, needs the strong pull-up */
+    uint8_t alarm;          /* Alarm flag from the last conversion */
+    uint8_t present;        /* 0: unplugged */
+    uint8_t frozen;         /* 1: answers commands but never converts again */
+    uint8_t segment;        /* GPIOB pin the device is wired to */
+    uint32_t conversions;   /* Completed conversions */
+    uint32_t slotErrors;    /* Write slots with a 15..60 us low (undefined bit) */
+} OwSimDevice_t;
+
+/* ========== Function Prototypes ========== */
+
+/**
+ * @brief Reset the bus, remove all devices and clear the waveform
+ * @param overheadNs: Simulated execution time of each PHY hook call
+ */
+void OneWireSim_Init(uint32_t overheadNs);
+
+/**
+ * @brief Put a DS18B20 on the DS18B20_PIN bus in its power-on state
+ * @param serial: 48-bit serial number (family 0x28 and CRC are added)
+ * @param tempQ4: Initial temperature (1/16 degC)
+ * @param parasite: 1 for parasite power
+ * @retval Device model, owned by the simulator
+ */
+OwSimDevice_t *OneWireSim_AddDevice(uint64_t serial, int16_t tempQ4, uint8_t parasite);
+
+/**
+ * @brief Put a DS18B20 on another GPIOB segment (onewire_multi.c)
+ * @param segment: Pin number 0..15, other parameters as OneWireSim_AddDevice()
+ * @retval Device model, owned by the simulator
+ */
+OwSimDevice_t *OneWireSim_AddSegmentDevice(uint8_t segment, uint64_t serial, int16_t tempQ4, uint8_t parasite);
+
+/** @brief Short DQ to ground (1) or remove the short (0) */
+void OneWireSim_ShortBus(uint8_t shorted);
+
+/** @brief Drop the recorded waveform (devices keep their state) */
+void OneWireSim_ClearWaveform(void);
+
+/**
+ * @brief Recorded waveform
+ * @param count: Number of events
+ * @retval Events in recording order
+ */
+const OwSimEvent_t *OneWireSim_Waveform(uint32_t *count);
+
+/** @brief Time of the last master edge (ns) */
+uint64_t OneWireSim_LastEdgeNs(void);
+
+/**
+ * @brief Measure every reset, presence and time slot in the waveform
+ * @param report: Filled with per-parameter min/max and violations
+ */
+void OneWireSim_Margins(OwSimReport_t *report);
+
+/** @brief Print a margin table (observed vs datasheet vs nominal) */
+void OneWireSim_PrintReport(FILE *out, const OwSimReport_t *report);
+
+/**
+ * @brief Dump the waveform as a VCD file (master drive and bus level)
+ * @retval 0 on success
+ */
+int OneWireSim_DumpVcd(const char *path);
+
+/**
+ * @brief Dallas CRC8, plain bitwise reference (independent of DS18B20.c)
+ */
+uint8_t OneWireSim_Crc8(const uint8_t *data, uint8_t length);
+
+#endif /* ONEWIRE_SIM_H_ */
@@ -0,0 +1,389 @@
+/**
+  ******************************************************************************
+  * @file    hal_stub.c
+  * @brief   Host stand-in for the STM32F1 HAL: simulated time, GPIO, I2C,
+  *          flash
+  * @details Blocking I2C transfers cost their wire time at 100 kHz
+  *          (9 clocks per byte incl. ACK). A DMA transfer stays pending
+  *          until the test completes or fails it, like the real DMA IRQ.
+  ******************************************************************************
+  */
+
+#include "stm32f1xx_hal.h"
+#include <string.h>
+#include <sys/mman.h>
+
+#define STUB_TICK_POLL_NS       1000ULL     /* One HAL_GetTick() poll */
+#define STUB_DWT_POLL_NS        100ULL      /* One DWT->CYCCNT poll (~7 cycles) */
+#define STUB_I2C_BYTE_NS        90000ULL    /* 9 SCL clocks at 100 kHz */
+
+uint32_t SystemCoreClock = 72000000U;
+uint64_t HAL_Stub_TimeNs = 0;
+uint32_t HAL_Stub_Primask = 0;
+uint64_t HAL_Stub_MaskMaxNs = 0;
+CoreDebug_Type HAL_Stub_CoreDebug;
+GPIO_TypeDef HAL_Stub_GPIOA;
+GPIO_TypeDef HAL_Stub_GPIOB;
+
+static DWT_Type stubDwt;
+static uint64_t maskStartNs;
+
+typedef struct {
+    uint16_t addr;
+    HAL_Stub_I2cDevice_t dev;
+} StubI2cSlot_t;
+
+static StubI2cSlot_t i2cSlots[HAL_STUB_I2C_MAX_DEVICES];
+static uint8_t i2cSlotCount;
+static uint8_t i2cFailNextDma;
+static uint32_t i2cBusyReturns;
+static uint64_t i2cAbortDoneNs;
+static struct {
+    uint16_t addr;
+    uint8_t *data;
+    uint16_t size;
+} i2cDma;
+static uint8_t *flashMem;
+static uint8_t flashUnlocked;
+static uint32_t flashErases;
+
+/* ========== Core ========== */
+
+uint32_t HAL_GetTick(void)
+{
+    HAL_Stub_TimeNs += STUB_TICK_POLL_NS;
+    return (uint32_t)(HAL_Stub_TimeNs / 1000000ULL);
+}
+
+void HAL_Delay(uint32_t ms)
+{
+    HAL_Stub_TimeNs += (uint64_t)ms * 1000000ULL;
+}
+
+DWT_Type *HAL_Stub_Dwt(void)
+{
+    HAL_Stub_TimeNs += STUB_DWT_POLL_NS;
+    stubDwt.CYCCNT = (uint32_t)(HAL_Stub_TimeNs * (SystemCoreClock / 1000000U) / 1000ULL);
+    return &stubDwt;
+}
+
+void HAL_Stub_SetPrimask(uint32_t v)
+{
+    if (v && !HAL_Stub_Primask)
+    {
+        maskStartNs = HAL_Stub_TimeNs;
+    }
+    else if (!v && HAL_Stub_Primask && HAL_Stub_TimeNs - maskStartNs > HAL_Stub_MaskMaxNs)
+    {
+        HAL_Stub_MaskMaxNs = HAL_Stub_TimeNs - maskStartNs;
+    }
+    HAL_Stub_Primask = v;
+}
+
+/* ========== GPIO ========== */
+
+void HAL_GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init)
+{
+    (void)port;
+    (void)init;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state)
+{
+    if (state == GPIO_PIN_SET)
+    {
+        port->ODR |= pin;
+    }
+    else
+    {
+        port->ODR &= ~(uint32_t)pin;
+    }
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *port, uint16_t pin)
+{
+    return (port->IDR & pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+/* ========== I2C ========== */
+
+static const HAL_Stub_I2cDevice_t *StubI2cFind(uint16_t addr)
+{
+    for (uint8_t i = 0; i < i2cSlotCount; i++)
+    {
+        if (i2cSlots[i].addr == addr)
+        {
+            return &i2cSlots[i].dev;
+        }
+    }
+    return NULL;
+}
+
+/** @brief Common checks for a blocking transfer; HAL_OK if it may start */
+static HAL_StatusTypeDef StubI2cBegin(I2C_HandleTypeDef *hi2c, uint16_t addr, uint16_t size,
+                                      const HAL_Stub_I2cDevice_t **dev)
+{
+    if (HAL_I2C_GetState(hi2c) != HAL_I2C_STATE_READY)
+    {
+        i2cBusyReturns++;
+        return HAL_BUSY;
+    }
+    HAL_Stub_TimeNs += (uint64_t)(size + 1) * STUB_I2C_BYTE_NS;
+    *dev = StubI2cFind(addr);
+    return (*dev != NULL) ? HAL_OK : HAL_ERROR;    /* Address NACK */
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef *hi2c, uint16_t addr, uint8_t *data, uint16_t size, uint32_t timeout)
+{
+    const HAL_Stub_I2cDevice_t *dev;
+    HAL_StatusTypeDef status = StubI2cBegin(hi2c, addr, size, &dev);
+
+    (void)timeout;
+    if (status != HAL_OK)
+    {
+        return status;
+    }
+    return dev->write ? dev->write(dev->ctx, data, size) : HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef *hi2c, uint16_t addr, uint8_t *data, uint16_t size, uint32_t timeout)
+{
+    const HAL_Stub_I2cDevice_t *dev;
+    HAL_StatusTypeDef status = StubI2cBegin(hi2c, addr, size, &dev);
+
+    (void)timeout;
+    if (status != HAL_OK)
+    {
+        return status;
+    }
+    return dev->read ? dev->read(dev->ctx, data, size) : HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t addr, uint16_t memAddr, uint16_t memAddrSize,
+                                   uint8_t *data, uint16_t size, uint32_t timeout)
+{
+    uint8_t reg = (uint8_t)memAddr;
+    HAL_StatusTypeDef status;
+
+    (void)memAddrSize;
+    status = HAL_I2C_Master_Transmit(hi2c, addr, &reg, 1, timeout);
+    if (status != HAL_OK)
+    {
+        return status;
+    }
+    return HAL_I2C_Master_Receive(hi2c, addr, data, size, timeout);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_DMA(I2C_HandleTypeDef *hi2c, uint16_t addr, uint8_t *data, uint16_t size)
+{
+    if (HAL_I2C_GetState(hi2c) != HAL_I2C_STATE_READY)
+    {
+        i2cBusyReturns++;
+        return HAL_BUSY;
+    }
+    if (i2cFailNextDma)
+    {
+        i2cFailNextDma = 0;
+        return HAL_ERROR;
+    }
+    i2cDma.addr = addr;
+    i2cDma.data = data;
+    i2cDma.size = size;
+    hi2c->State = HAL_I2C_STATE_BUSY_TX;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Abort_IT(I2C_HandleTypeDef *hi2c, uint16_t addr)
+{
+    (void)addr;
+    if (hi2c->State != HAL_I2C_STATE_BUSY_TX)
+    {
+        return HAL_ERROR;
+    }
+    i2cDma.data = NULL;
+    hi2c->State = HAL_I2C_STATE_ABORT;
+    i2cAbortDoneNs = HAL_Stub_TimeNs + HAL_STUB_I2C_ABORT_NS;
+    return HAL_OK;
+}
+
+HAL_I2C_StateTypeDef HAL_I2C_GetState(I2C_HandleTypeDef *hi2c)
+{
+    if (hi2c->State == HAL_I2C_STATE_RESET)
+    {
+        hi2c->State = HAL_I2C_STATE_READY;  /* MX_I2C1_Init() is not run on the host */
+    }
+    if (hi2c->State == HAL_I2C_STATE_ABORT && HAL_Stub_TimeNs >= i2cAbortDoneNs)
+    {
+        hi2c->State = HAL_I2C_STATE_READY;
+    }
+    return hi2c->State;
+}
+
+__attribute__((weak)) void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    (void)hi2c;
+}
+
+__attribute__((weak)) void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+    (void)hi2c;
+}
+
+/* ========== FLASH ========== */
+
+static uint8_t StubFlashInRange(uint32_t addr, uint32_t size)
+{
+    return flashMem != NULL && addr >= HAL_STUB_FLASH_BASE &&
+           addr + size <= HAL_STUB_FLASH_BASE + HAL_STUB_FLASH_SIZE;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void)
+{
+    flashUnlocked = 1;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void)
+{
+    flashUnlocked = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data)
+{
+    uint8_t *cell = (uint8_t *)(uintptr_t)Address;
+
+    if (!flashUnlocked || TypeProgram != FLASH_TYPEPROGRAM_HALFWORD ||
+        (Address & 1U) || !StubFlashInRange(Address, 2))
+    {
+        return HAL_ERROR;
+    }
+    if (cell[0] != 0xFF || cell[1] != 0xFF)
+    {
+        return HAL_ERROR;   /* PGERR: not erased */
+    }
+    cell[0] = (uint8_t)Data;
+    cell[1] = (uint8_t)(Data >> 8);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError)
+{
+    uint32_t addr = pEraseInit->PageAddress;
+    uint32_t size = pEraseInit->NbPages * FLASH_PAGE_SIZE;
+
+    *PageError = 0xFFFFFFFFU;
+    if (!flashUnlocked || pEraseInit->TypeErase != FLASH_TYPEERASE_PAGES ||
+        (addr % FLASH_PAGE_SIZE) != 0 || !StubFlashInRange(addr, size))
+    {
+        *PageError = addr;
+        return HAL_ERROR;
+    }
+    memset((uint8_t *)(uintptr_t)addr, 0xFF, size);
+    flashErases += pEraseInit->NbPages;
+    return HAL_OK;
+}
+
+/* ========== Test Hooks ========== */
+
+void HAL_Stub_Reset(void)
+{
+    HAL_Stub_TimeNs = 0;
+    HAL_Stub_Primask = 0;
+    HAL_Stub_MaskMaxNs = 0;
+    i2cSlotCount = 0;
+    i2cFailNextDma = 0;
+    i2cBusyReturns = 0;
+    i2cDma.data = NULL;
+}
+
+void HAL_Stub_I2cAttach(uint16_t addr, const HAL_Stub_I2cDevice_t *dev)
+{
+    HAL_Stub_I2cDetach(addr);
+    if (i2cSlotCount < HAL_STUB_I2C_MAX_DEVICES)
+    {
+        i2cSlots[i2cSlotCount].addr = addr;
+        i2cSlots[i2cSlotCount].dev = *dev;
+        i2cSlotCount++;
+    }
+}
+
+void HAL_Stub_I2cDetach(uint16_t addr)
+{
+    for (uint8_t i = 0; i < i2cSlotCount; i++)
+    {
+        if (i2cSlots[i].addr == addr)
+        {
+            i2cSlots[i] = i2cSlots[--i2cSlotCount];
+            return;
+        }
+    }
+}
+
+void HAL_Stub_I2cFailNextDma(void)
+{
+    i2cFailNextDma = 1;
+}
+
+uint8_t HAL_Stub_I2cDmaPending(void)
+{
+    return i2cDma.data != NULL;
+}
+
+void HAL_Stub_I2cDmaComplete(I2C_HandleTypeDef *hi2c)
+{
+    const HAL_Stub_I2cDevice_t *dev;
+
+    if (i2cDma.data == NULL)
+    {
+        return;
+    }
+    HAL_Stub_TimeNs += (uint64_t)(i2cDma.size + 1) * STUB_I2C_BYTE_NS;
+    dev = StubI2cFind(i2cDma.addr);
+    if (dev != NULL && dev->write != NULL)
+    {
+        dev->write(dev->ctx, i2cDma.data, i2cDma.size);
+    }
+    i2cDma.data = NULL;
+    hi2c->State = HAL_I2C_STATE_READY;
+    HAL_I2C_MasterTxCpltCallback(hi2c);
+}
+
+void HAL_Stub_I2cDmaError(I2C_HandleTypeDef *hi2c)
+{
+    if (i2cDma.data == NULL)
+    {
+        return;
+    }
+    i2cDma.data = NULL;
+    hi2c->State = HAL_I2C_STATE_READY;
+    HAL_I2C_ErrorCallback(hi2c);
+}
+
+uint32_t HAL_Stub_I2cBusyReturns(void)
+{
+    return i2cBusyReturns;
+}
+
+uint8_t *HAL_Stub_FlashMap(void)
+{
+    if (flashMem == NULL)
+    {
+        void *p = mmap((void *)HAL_STUB_FLASH_BASE, HAL_STUB_FLASH_SIZE, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+        if (p != (void *)HAL_STUB_FLASH_BASE)
+        {
+            return NULL;
+        }
+        flashMem = p;
+    }
+    memset(flashMem, 0xFF, HAL_STUB_FLASH_SIZE);
+    flashUnlocked = 0;
+    flashErases = 0;
+    return flashMem;
+}
+
+uint32_t HAL_Stub_FlashErases(void)
+{
+    return flashErases;
+}
@@ -0,0 +1,191 @@
+/**
+  ******************************************************************************
+  * @file    stm32f1xx_hal.h
+  * @brief   Host stand-in for the STM32F1 HAL/CMSIS used by the driver tests
+  * @details Only what Core/Src needs to compile on the host. Time is
+  *          simulated: HAL_GetTick(), HAL_Delay() and DWT->CYCCNT all read
+  *          HAL_Stub_TimeNs, and each poll of HAL_GetTick() or DWT costs a
+  *          little simulated time so busy-wait loops terminate. I2C calls
+  *          are routed to fake devices attached with HAL_Stub_I2cAttach().
+  ******************************************************************************
+  */
+
+#ifndef STM32F1XX_HAL_STUB_H_
+#define STM32F1XX_HAL_STUB_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* ========== Core ========== */
+typedef enum {
+    HAL_OK = 0x00,
+    HAL_ERROR = 0x01,
+    HAL_BUSY = 0x02,
+    HAL_TIMEOUT = 0x03
+} HAL_StatusTypeDef;
+
+#define UNUSED(x)       ((void)(x))
+#define __RAM_FUNC
+#define __ASM           __asm__
+
+extern uint32_t SystemCoreClock;
+extern uint64_t HAL_Stub_TimeNs;          /* Simulated time since reset */
+
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t ms);
+
+/* PRIMASK: no real interrupts, masked intervals are timed on simulated time */
+extern uint32_t HAL_Stub_Primask;
+extern uint64_t HAL_Stub_MaskMaxNs;       /* Longest PRIMASK = 1 interval */
+void HAL_Stub_SetPrimask(uint32_t v);
+static inline uint32_t __get_PRIMASK(void) { return HAL_Stub_Primask; }
+static inline void __set_PRIMASK(uint32_t v) { HAL_Stub_SetPrimask(v); }
+static inline void __disable_irq(void) { HAL_Stub_SetPrimask(1); }
+static inline void __enable_irq(void) { HAL_Stub_SetPrimask(0); }
+static inline uint32_t __CLZ(uint32_t v) { return v ? (uint32_t)__builtin_clz(v) : 32U; }
+
+/* ========== DWT / CoreDebug ========== */
+typedef struct {
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+DWT_Type *HAL_Stub_Dwt(void);             /* Refreshes CYCCNT from simulated time */
+extern CoreDebug_Type HAL_Stub_CoreDebug;
+
+#define DWT                         (HAL_Stub_Dwt())
+#define CoreDebug                   (&HAL_Stub_CoreDebug)
+#define CoreDebug_DEMCR_TRCENA_Msk  (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk      (1UL << 0)
+
+/* ========== GPIO ========== */
+typedef struct {
+    volatile uint32_t CRL;
+    volatile uint32_t CRH;
+    volatile uint32_t IDR;
+    volatile uint32_t ODR;
+    volatile uint32_t BSRR;
+    volatile uint32_t BRR;
+    volatile uint32_t LCKR;
+} GPIO_TypeDef;
+
+typedef struct {
+    uint32_t Pin;
+    uint32_t Mode;
+    uint32_t Pull;
+    uint32_t Speed;
+} GPIO_InitTypeDef;
+
+typedef enum {
+    GPIO_PIN_RESET = 0,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+extern GPIO_TypeDef HAL_Stub_GPIOA;
+extern GPIO_TypeDef HAL_Stub_GPIOB;
+#define GPIOA                   (&HAL_Stub_GPIOA)
+#define GPIOB                   (&HAL_Stub_GPIOB)
+
+#define GPIO_PIN_0              ((uint16_t)0x0001)
+#define GPIO_PIN_1              ((uint16_t)0x0002)
+#define GPIO_PIN_2              ((uint16_t)0x0004)
+#define GPIO_PIN_3              ((uint16_t)0x0008)
+#define GPIO_PIN_4              ((uint16_t)0x0010)
+#define GPIO_PIN_5              ((uint16_t)0x0020)
+#define GPIO_PIN_8              ((uint16_t)0x0100)
+#define GPIO_PIN_9              ((uint16_t)0x0200)
+#define GPIO_PIN_10             ((uint16_t)0x0400)
+#define GPIO_PIN_13             ((uint16_t)0x2000)
+#define GPIO_PIN_14             ((uint16_t)0x4000)
+#define GPIO_PIN_15             ((uint16_t)0x8000)
+
+#define GPIO_MODE_INPUT         0x00000000U
+#define GPIO_MODE_OUTPUT_PP     0x00000001U
+#define GPIO_MODE_OUTPUT_OD     0x00000011U
+#define GPIO_NOPULL             0x00000000U
+#define GPIO_PULLUP             0x00000001U
+#define GPIO_SPEED_FREQ_LOW     0x00000002U
+#define GPIO_SPEED_FREQ_HIGH    0x00000003U
+
+#define __HAL_RCC_GPIOB_CLK_ENABLE()    ((void)0)
+
+void HAL_GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init);
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *port, uint16_t pin);
+
+/* ========== I2C ========== */
+typedef enum {
+    HAL_I2C_STATE_RESET = 0x00U,
+    HAL_I2C_STATE_READY = 0x20U,
+    HAL_I2C_STATE_BUSY_TX = 0x21U,
+    HAL_I2C_STATE_BUSY_RX = 0x22U,
+    HAL_I2C_STATE_ABORT = 0x60U
+} HAL_I2C_StateTypeDef;
+
+typedef struct {
+    volatile HAL_I2C_StateTypeDef State;
+} I2C_HandleTypeDef;
+
+#define I2C_MEMADD_SIZE_8BIT    0x00000001U
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef *hi2c, uint16_t addr, uint8_t *data, uint16_t size, uint32_t timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef *hi2c, uint16_t addr, uint8_t *data, uint16_t size, uint32_t timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t addr, uint16_t memAddr, uint16_t memAddrSize,
+                                   uint8_t *data, uint16_t size, uint32_t timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_DMA(I2C_HandleTypeDef *hi2c, uint16_t addr, uint8_t *data, uint16_t size);
+HAL_StatusTypeDef HAL_I2C_Master_Abort_IT(I2C_HandleTypeDef *hi2c, uint16_t addr);
+HAL_I2C_StateTypeDef HAL_I2C_GetState(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c);
+
+/* ========== FLASH ========== */
+#define FLASH_TYPEERASE_PAGES       0x00U
+#define FLASH_TYPEPROGRAM_HALFWORD  0x01U
+#define FLASH_PAGE_SIZE             0x400U      /* Medium density: 1 KB pages */
+
+typedef struct {
+    uint32_t TypeErase;
+    uint32_t Banks;
+    uint32_t PageAddress;
+    uint32_t NbPages;
+} FLASH_EraseInitTypeDef;
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void);
+HAL_StatusTypeDef HAL_FLASH_Lock(void);
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data);
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError);
+
+/* ========== Test Hooks ========== */
+/* A fake I2C device: write/read get the payload of one transfer */
+typedef struct {
+    void *ctx;
+    HAL_StatusTypeDef (*write)(void *ctx, const uint8_t *data, uint16_t size);
+    HAL_StatusTypeDef (*read)(void *ctx, uint8_t *data, uint16_t size);
+} HAL_Stub_I2cDevice_t;
+
+#define HAL_STUB_I2C_MAX_DEVICES    4
+#define HAL_STUB_I2C_ABORT_NS       50000ULL    /* Abort_IT takes 50 us to reach READY */
+
+void HAL_Stub_Reset(void);
+void HAL_Stub_I2cAttach(uint16_t addr, const HAL_Stub_I2cDevice_t *dev);
+void HAL_Stub_I2cDetach(uint16_t addr);
+void HAL_Stub_I2cFailNextDma(void);                     /* Next Transmit_DMA start returns HAL_ERROR */
+uint8_t HAL_Stub_I2cDmaPending(void);
+void HAL_Stub_I2cDmaComplete(I2C_HandleTypeDef *hi2c);  /* Deliver the DMA frame, TxCplt callback */
+void HAL_Stub_I2cDmaError(I2C_HandleTypeDef *hi2c);     /* Drop the DMA frame, Error callback */
+uint32_t HAL_Stub_I2cBusyReturns(void);                 /* HAL_BUSY results since reset */
+
+/* Flash is host memory mapped at its real address, so code that reads it
+   through a pointer runs unchanged. Erased cells read 0xFF; a halfword can
+   only be programmed once per erase (PGERR otherwise). */
+#define HAL_STUB_FLASH_BASE         0x08000000UL
+#define HAL_STUB_FLASH_SIZE         0x10000UL   /* STM32F103C8: 64 KB */
+
+uint8_t *HAL_Stub_FlashMap(void);                       /* Map (first call) and erase all of flash */
+uint32_t HAL_Stub_FlashErases(void);                    /* Pages erased since the map */
+
+#endif /* STM32F1XX_HAL_STUB_H_ */
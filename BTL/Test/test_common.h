@@ -0,0 +1,70 @@
+/**
+  ******************************************************************************
+  * @file    test_common.h
+  * @brief   Minimal assertion and runner macros for the host tests
+  * @details Each test case runs in a forked child so the drivers' static
+  *          state (sensor fleet, glyph cache, ...) starts fresh every time.
+  ******************************************************************************
+  */
+
+#ifndef TEST_COMMON_H_
+#define TEST_COMMON_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static int test_failures;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) \
+        { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(a, b) \
+    do { \
+        long long va_ = (long long)(a), vb_ = (long long)(b); \
+        if (va_ != vb_) \
+        { \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", \
+                    __FILE__, __LINE__, #a, #b, va_, vb_); \
+            test_failures++; \
+        } \
+    } while (0)
+
+/**
+ * @brief Run one test case in a child process
+ * @retval 0 if it passed, 1 otherwise
+ */
+static inline int RunTest(const char *name, void (*fn)(void))
+{
+    int status = 0;
+    pid_t pid;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid == 0)
+    {
+        test_failures = 0;
+        fn();
+        fflush(stdout);
+        _exit(test_failures ? 1 : 0);
+    }
+    waitpid(pid, &status, 0);
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+    {
+        printf("PASS %s\n", name);
+        return 0;
+    }
+    printf("FAIL %s\n", name);
+    return 1;
+}
+
+#define RUN(fn)     (failed += RunTest(#fn, fn))
+
+#endif /* TEST_COMMON_H_ */
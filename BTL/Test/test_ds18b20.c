@@ -0,0 +1,435 @@
+/**
+  ******************************************************************************
+  * @file    test_ds18b20.c
+  * @brief   DS18B20.c (GPIO transport) against the simulated 1-Wire bus
+  * @details Runs the real driver through the DS18B20_Phy* hooks of
+  *          onewire_sim.c and checks the protocol result and the slot
+  *          timing. Set OWSIM_VCD=<file> to dump the margin-test waveform.
+  ******************************************************************************
+  */
+
+#include "test_common.h"
+#include "onewire_sim.h"
+#include "DS18B20.h"
+#include "eeprom.h"
+#include <string.h>
+
+#define SERIAL_A        0x0000A1B2C3D4E5ULL
+#define SERIAL_B        0x00001122334455ULL
+#define TEMP_Q4(c16)    ((int16_t)(c16))        /* 1/16 degC */
+
+/* No flash on the host: every sensor starts uncalibrated, saves are recorded */
+static struct {
+    uint8_t rom[8];
+    int16_t offset;
+    int16_t gain;
+    uint8_t count;
+} savedCalib;
+
+HAL_StatusTypeDef EEPROM_LoadCalibration(const uint8_t *rom, int16_t *pOffset, int16_t *pGain)
+{
+    (void)rom;
+    *pOffset = 0;
+    *pGain = EEPROM_CALIB_GAIN_ONE;
+    return HAL_ERROR;
+}
+
+HAL_StatusTypeDef EEPROM_SaveCalibration(const uint8_t *rom, int16_t offset, int16_t gain)
+{
+    memcpy(savedCalib.rom, rom, 8);
+    savedCalib.offset = offset;
+    savedCalib.gain = gain;
+    savedCalib.count++;
+    return HAL_OK;
+}
+
+/* ========== Helpers ========== */
+
+static void BusInit(uint32_t overheadNs)
+{
+    HAL_Stub_Reset();
+    OneWireSim_Init(overheadNs);
+    DS18B20_Init();
+}
+
+/** @brief Drive the sensor.h cycle until a reading arrives (10 ms poll) */
+static uint8_t PollReading(Sensor_t *sensor, uint32_t maxMs)
+{
+    uint32_t end = HAL_GetTick() + maxMs;
+
+    while (HAL_GetTick() < end)
+    {
+        if (Sensor_Poll(sensor, HAL_GetTick()))
+        {
+            return 1;
+        }
+        HAL_Delay(10);
+    }
+    return 0;
+}
+
+static uint8_t RomListed(const uint8_t roms[][8], uint8_t count, const uint8_t *rom)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (memcmp(roms[i], rom, 8) == 0)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static uint8_t PinMode(void)
+{
+    uint32_t pos = 31U - __CLZ(DS18B20_PIN);
+    volatile uint32_t *cr = (pos < 8U) ? &DS18B20_PORT->CRL : &DS18B20_PORT->CRH;
+    return (uint8_t)((*cr >> ((pos & 7U) * 4U)) & 0xFU);
+}
+
+/* ========== Test Cases ========== */
+
+static void test_presence(void)
+{
+    BusInit(0);
+    CHECK_EQ(DS18B20_Start(), 0);
+
+    OneWireSim_AddDevice(SERIAL_A, TEMP_Q4(400), 0);
+    CHECK_EQ(DS18B20_Start(), 1);
+}
+
+static void test_crc_table_matches_bitwise(void)
+{
+    uint8_t buf[16];
+
+    for (uint16_t v = 0; v < 256; v++)
+    {
+        buf[0] = (uint8_t)v;
+        CHECK_EQ(DS18B20_CRC8(buf, 1), OneWireSim_Crc8(buf, 1));
+    }
+    srand(1);
+    for (uint16_t n = 0; n < 1000; n++)
+    {
+        uint8_t len = (uint8_t)(1 + rand() % sizeof(buf));
+        for (uint8_t i = 0; i < len; i++)
+        {
+            buf[i] = (uint8_t)rand();
+        }
+        CHECK_EQ(DS18B20_CRC8(buf, len), OneWireSim_Crc8(buf, len));
+    }
+}
+
+static void test_search_rom(void)
+{
+    uint8_t roms[DS18B20_MAX_SENSORS][8];
+    OwSimDevice_t *a, *b;
+    uint8_t n;
+
+    BusInit(0);
+    a = OneWireSim_AddDevice(SERIAL_A, TEMP_Q4(400), 0);
+    b = OneWireSim_AddDevice(SERIAL_B, TEMP_Q4(400), 0);
+    n = DS18B20_SearchRom(roms, DS18B20_MAX_SENSORS);
+    CHECK_EQ(n, 2);
+    CHECK(RomListed(roms, n, a->rom));
+    CHECK(RomListed(roms, n, b->rom));
+    CHECK_EQ(a->slotErrors + b->slotErrors, 0);
+}
+
+static void test_scratchpad(void)
+{
+    uint8_t sp[DS18B20_SCRATCHPAD_SIZE];
+    OwSimDevice_t *a;
+
+    BusInit(0);
+    a = OneWireSim_AddDevice(SERIAL_A, TEMP_Q4(-10 * 16 - 8), 0);
+    OneWireSim_AddDevice(SERIAL_B, TEMP_Q4(400), 0);
+
+    /* Power-on value before any conversion */
+    CHECK_EQ(DS18B20_ReadScratchpad(a->rom, sp), HAL_OK);
+    CHECK_EQ((int16_t)(sp[1] << 8 | sp[0]), DS18B20_RAW_POWER_ON);
+
+    CHECK(DS18B20_Select(NULL));
+    DS18B20_Write(0x44);
+    HAL_Delay(DS18B20_CONV_TIME_MS);
+    CHECK_EQ(DS18B20_ReadScratchpad(a->rom, sp), HAL_OK);
+    CHECK_EQ((int16_t)(sp[1] << 8 | sp[0]), -10 * 16 - 8);
+    CHECK_EQ(a->conversions, 1);
+}
+
+static void test_sensor_ops_cycle(void)
+{
+    Sensor_t sensor = SENSOR_ENTRY(&DS18B20_SensorOps, NULL, 1000, DS18B20_CONV_TIMEOUT_MS, 0);
+    OwSimDevice_t *a;
+
+    BusInit(0);
+    a = OneWireSim_AddDevice(SERIAL_A, TEMP_Q4(25 * 16 + 8), 0);
+    Sensor_Init(&sensor, HAL_GetTick());
+    CHECK(PollReading(&sensor, 2000));
+    CHECK_EQ(sensor.temp, (25 * 16 + 8) * 16);
+    CHECK_EQ(Sensor_Health(&sensor), SENSOR_HEALTH_OK);
+
+    /* Next cycle follows the device */
+    a->tempQ4 = TEMP_Q4(26 * 16);
+    CHECK(PollReading(&sensor, 2000));
+    CHECK_EQ(sensor.temp, 26 * 256);
+
+    /* Unplugged: reading stops, health drops */
+    a->present = 0;
+    CHECK(!PollReading(&sensor, 2000));
+    CHECK(Sensor_Health(&sensor) != SENSOR_HEALTH_OK);
+}
+
+static void test_sensor_ops_oversampled(void)
+{
+    /* Same entry as the app_tasks.c sensor table */
+    Sensor_t sensor = SENSOR_ENTRY(&DS18B20_SensorOps, NULL, 500, DS18B20_CONV_TIMEOUT_MS, 2);
+    OwSimDevice_t *a;
+
+    BusInit(0);
+    a = OneWireSim_AddDevice(SERIAL_A, TEMP_Q4(25 * 16 + 1), 0);
+    Sensor_Init(&sensor, HAL_GetTick());
+    CHECK(PollReading(&sensor, 5000));
+    CHECK_EQ(a->conversions, 4);
+    CHECK_EQ(sensor.temp, (25 * 16 + 1) * 16);
+    CHECK_EQ(Sensor_ResolutionBits(&sensor), 5);
+}
+
+static void test_calibrate_primary(void)
+{
+    Sensor_t sensor = SENSOR_ENTRY(&DS18B20_SensorOps, NULL, 1000, DS18B20_CONV_TIMEOUT_MS, 0);
+    OwSimDevice_t *a;
+
+    /* No reading yet: nothing to calibrate against */
+    BusInit(0);
+    CHECK_EQ(DS18B20_CalibratePrimary(TEMP_FROM_INT(25)), HAL_ERROR);
+
+    a = OneWireSim_AddDevice(SERIAL_A, TEMP_Q4(24 * 16 + 8), 0);   /* Reads 24.5 */
+    Sensor_Init(&sensor, HAL_GetTick());
+    CHECK(PollReading(&sensor, 2000));
+
+    /* Offsets beyond DS18B20_CAL_MAX_OFFSET are refused, nothing saved */
+    CHECK_EQ(DS18B20_CalibratePrimary(TEMP_FROM_INT(30)), HAL_ERROR);
+    CHECK_EQ(savedCalib.count, 0);
+
+    CHECK_EQ(DS18B20_CalibratePrimary(TEMP_FROM_INT(25)), HAL_OK);
+    CHECK_EQ(savedCalib.count, 1);
+    CHECK(memcmp(savedCalib.rom, a->rom, 8) == 0);
+    CHECK_EQ(savedCalib.offset, TEMP_ONE / 2);
+    CHECK_EQ(savedCalib.gain, EEPROM_CALIB_GAIN_ONE);
+
+    /* Later readings carry the offset */
+    a->tempQ4 = TEMP_Q4(20 * 16);
+    CHECK(PollReading(&sensor, 2000));
+    CHECK_EQ(sensor.temp, TEMP_FROM_INT(20) + TEMP_ONE / 2);
+}
+
+static void test_alarm_search(void)
+{
+    Sensor_t sensor = SENSOR_ENTRY(&DS18B20_SensorOps, NULL, 1000, DS18B20_CONV_TIMEOUT_MS, 0);
+    uint8_t roms[DS18B20_MAX_SENSORS][8];
+    OwSimDevice_t *a, *b;
+    uint8_t n;
+
+    BusInit(0);
+    a = OneWireSim_AddDevice(SERIAL_A, TEMP_Q4(25 * 16), 0);
+    b = OneWireSim_AddDevice(SERIAL_B, TEMP_Q4(35 * 16), 0);
+    DS18B20_SetAlarmBand(20, 30);
+    Sensor_Init(&sensor, HAL_GetTick());
+
+    /* First cycle writes TH/TL, the second conversion raises the flags */
+    CHECK(PollReading(&sensor, 2000));
+    CHECK_EQ((int8_t)a->scratchpad[2], 30);
+    CHECK_EQ((int8_t)a->scratchpad[3], 20);
+    CHECK(PollReading(&sensor, 2000));
+    CHECK(!a->alarm);
+    CHECK(b->alarm);
+
+    n = DS18B20_AlarmSearch(roms, DS18B20_MAX_SENSORS);
+    CHECK_EQ(n, 1);
+    CHECK(RomListed(roms, n, b->rom));
+}
+
+static void test_parasite_strong_pullup(void)
+{
+    Sensor_t sensor = SENSOR_ENTRY(&DS18B20_SensorOps, NULL, 1000, DS18B20_CONV_TIMEOUT_MS, 0);
+    OwSimDevice_t *a;
+
+    BusInit(0);
+    a = OneWireSim_AddDevice(SERIAL_A, TEMP_Q4(22 * 16 + 4), 1);
+    CHECK_EQ(DS18B20_IsParasite(NULL), 1);
+
+    Sensor_Init(&sensor, HAL_GetTick());
+    CHECK_EQ(Sensor_Poll(&sensor, HAL_GetTick()), 0);   /* Starts Convert T */
+    CHECK(DS18B20_IsBusLocked());
+    CHECK_EQ(PinMode(), 0x3);                           /* Push-pull high */
+    CHECK(HAL_Stub_TimeNs - OneWireSim_LastEdgeNs() < 10000);
+
+    CHECK(PollReading(&sensor, 2000));
+    CHECK(!DS18B20_IsBusLocked());
+    CHECK(PinMode() != 0x3);
+    CHECK_EQ(sensor.temp, (22 * 16 + 4) * 16);          /* Conversion had power */
+    CHECK_EQ(a->conversions, 1);
+}
+
+static void test_irq_mask_stats_match_stub(void)
+{
+    Sensor_t sensor = SENSOR_ENTRY(&DS18B20_SensorOps, NULL, 1000, DS18B20_CONV_TIMEOUT_MS, 0);
+    uint32_t cyclesPerUs = SystemCoreClock / 1000000U;
+    uint32_t stubCycles;
+    OwSimDevice_t *a;
+
+    BusInit(0);
+    a = OneWireSim_AddDevice(SERIAL_A, TEMP_Q4(22 * 16), 1);
+
+    /* Plain slots: the longest mask is the presence window */
+    DS18B20_ResetIrqMaskStats();
+    HAL_Stub_MaskMaxNs = 0;
+    CHECK(DS18B20_Start());
+    DS18B20_Write(0xCC);
+    DS18B20_Write(0xBE);
+    (void)DS18B20_Read();
+    stubCycles = (uint32_t)(HAL_Stub_MaskMaxNs * cyclesPerUs / 1000U);
+    CHECK(DS18B20_GetIrqMaskMaxCycles() >= DS18B20_T_PRESENCE_US * cyclesPerUs);
+    CHECK(DS18B20_GetIrqMaskMaxCycles() <= stubCycles);
+
+    /* 0x44 ends on a write-0 masked together with the pull-up switch */
+    Sensor_Init(&sensor, HAL_GetTick());
+    DS18B20_ResetIrqMaskStats();
+    HAL_Stub_MaskMaxNs = 0;
+    CHECK_EQ(Sensor_Poll(&sensor, HAL_GetTick()), 0);   /* Starts Convert T */
+    CHECK(DS18B20_IsBusLocked());
+    CHECK_EQ(HAL_Stub_Primask, 0);
+    CHECK_EQ(a->slotErrors, 0);
+
+    /* Driver figure = true longest mask, less the DWT read in Enter */
+    stubCycles = (uint32_t)(HAL_Stub_MaskMaxNs * cyclesPerUs / 1000U);
+    CHECK(DS18B20_GetIrqMaskMaxCycles() <= stubCycles);
+    CHECK(DS18B20_GetIrqMaskMaxCycles() + 2 * cyclesPerUs >= stubCycles);
+}
+
+static void test_stable_temperature_not_stuck(void)
+{
+    Sensor_t sensor = SENSOR_ENTRY(&DS18B20_SensorOps, NULL, 500, DS18B20_CONV_TIMEOUT_MS, 0);
+    uint16_t readings = 0;
+
+    BusInit(0);
+    OneWireSim_AddDevice(SERIAL_A, TEMP_Q4(21 * 16 + 3), 0);
+    Sensor_Init(&sensor, HAL_GetTick());
+
+    /* A 12-bit sensor in a quiet room: the same scratchpad, cycle after cycle */
+    for (uint16_t n = 0; n < 3 * DS18B20_STUCK_LIMIT; n++)
+    {
+        readings += PollReading(&sensor, 2000);
+    }
+    CHECK_EQ(readings, 3 * DS18B20_STUCK_LIMIT);
+    CHECK_EQ(Sensor_Health(&sensor), SENSOR_HEALTH_OK);
+    CHECK_EQ(sensor.temp, (21 * 16 + 3) * 16);
+}
+
+static void test_frozen_sensor_goes_stuck(void)
+{
+    Sensor_t sensor = SENSOR_ENTRY(&DS18B20_SensorOps, NULL, 500, DS18B20_CONV_TIMEOUT_MS, 0);
+    DS18B20_Sensor_t fleet[1];
+    OwSimDevice_t *a;
+    uint16_t readings = 0;
+
+    BusInit(0);
+    a = OneWireSim_AddDevice(SERIAL_A, TEMP_Q4(21 * 16), 0);
+    Sensor_Init(&sensor, HAL_GetTick());
+    CHECK(PollReading(&sensor, 2000));
+
+    /* Stops converting: scratchpad frozen, Convert T never makes the bus busy */
+    a->frozen = 1;
+    a->tempQ4 = TEMP_Q4(30 * 16);
+    for (uint16_t n = 0; n < DS18B20_STUCK_LIMIT + 8; n++)
+    {
+        readings += PollReading(&sensor, 2000);
+    }
+    CHECK(readings < DS18B20_STUCK_LIMIT + 8);
+    CHECK_EQ(Sensor_Health(&sensor), SENSOR_HEALTH_ERROR);
+    CHECK(!PollReading(&sensor, 2000));                 /* Stays STUCK, no flapping */
+    CHECK(!PollReading(&sensor, 2000));
+
+    /* Converting again: back to OK with the new value */
+    a->frozen = 0;
+    CHECK(PollReading(&sensor, 5000));
+    CHECK(PollReading(&sensor, 2000));
+    CHECK_EQ(sensor.temp, 30 * 256);
+
+    /* Bus shorted to ground: all-zero scratchpad is STUCK, not a CRC error */
+    CHECK_EQ(DS18B20_Enumerate(fleet, 0, 1), 1);
+    OneWireSim_ShortBus(1);
+    CHECK_EQ(DS18B20_ReadSensor(&fleet[0]), HAL_ERROR);
+    CHECK_EQ(fleet[0].status, DS18B20_STATUS_STUCK);
+}
+
+/** @brief Full bus cycle with two sensors, then the timing report */
+static void RunMarginCycle(uint32_t overheadNs, OwSimReport_t *report)
+{
+    Sensor_t sensor = SENSOR_ENTRY(&DS18B20_SensorOps, NULL, 1000, DS18B20_CONV_TIMEOUT_MS, 0);
+    OwSimDevice_t *a, *b;
+
+    BusInit(overheadNs);
+    a = OneWireSim_AddDevice(SERIAL_A, TEMP_Q4(25 * 16), 0);
+    b = OneWireSim_AddDevice(SERIAL_B, TEMP_Q4(35 * 16), 0);
+    DS18B20_SetAlarmBand(20, 30);
+    Sensor_Init(&sensor, HAL_GetTick());
+    CHECK(PollReading(&sensor, 2000));
+    CHECK(PollReading(&sensor, 2000));
+    CHECK_EQ(a->slotErrors + b->slotErrors, 0);
+
+    OneWireSim_Margins(report);
+    printf("PHY overhead %u ns:\n", overheadNs);
+    OneWireSim_PrintReport(stdout, report);
+}
+
+static void test_slot_margins(void)
+{
+    OwSimReport_t report;
+    const char *vcd = getenv("OWSIM_VCD");
+
+    RunMarginCycle(0, &report);
+    CHECK_EQ(report.violations, 0);
+    for (uint8_t t = 0; t < OWSIM_T_COUNT; t++)
+    {
+        CHECK(report.t[t].count > 0);
+    }
+    if (vcd != NULL)
+    {
+        CHECK_EQ(OneWireSim_DumpVcd(vcd), 0);
+    }
+
+    /* Four PHY calls sit between the falling edge and the read sample */
+    RunMarginCycle(500, &report);
+    CHECK_EQ(report.violations, 0);
+}
+
+static void test_slot_margins_detect_slow_phy(void)
+{
+    OwSimReport_t report;
+
+    /* 1.5 us per call pushes the read sample past 15 us */
+    RunMarginCycle(1500, &report);
+    CHECK(report.t[OWSIM_T_READ_SAMPLE].violations > 0);
+}
+
+int main(void)
+{
+    int failed = 0;
+
+    RUN(test_presence);
+    RUN(test_crc_table_matches_bitwise);
+    RUN(test_search_rom);
+    RUN(test_scratchpad);
+    RUN(test_sensor_ops_cycle);
+    RUN(test_sensor_ops_oversampled);
+    RUN(test_calibrate_primary);
+    RUN(test_alarm_search);
+    RUN(test_parasite_strong_pullup);
+    RUN(test_irq_mask_stats_match_stub);
+    RUN(test_stable_temperature_not_stuck);
+    RUN(test_frozen_sensor_goes_stuck);
+    RUN(test_slot_margins);
+    RUN(test_slot_margins_detect_slow_phy);
+    return failed ? 1 : 0;
+}
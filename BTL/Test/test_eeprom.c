@@ -0,0 +1,166 @@
+/**
+  ******************************************************************************
+  * @file    test_eeprom.c
+  * @brief   eeprom.c on the stub flash: v1 -> v2 migration and calibration
+  * @details The stub maps host memory at the real flash address, so
+  *          EEPROM_Init() reads the page through the same pointer casts as
+  *          on the target. A v1 page is built byte by byte as the v1
+  *          firmware left it: magic, setTemp, one pad byte, CRC16 over those
+  *          6 bytes at offset 6, the rest of the page erased.
+  ******************************************************************************
+  */
+
+#include "test_common.h"
+#include "eeprom.h"
+#include <stddef.h>
+#include <string.h>
+
+static const uint8_t romA[8] = { 0x28, 0xE5, 0xD4, 0xC3, 0xB2, 0xA1, 0x00, 0x5C };
+static const uint8_t romB[8] = { 0x28, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0x9A };
+
+/* ========== Helpers ========== */
+
+static uint8_t *Page(void)
+{
+    return (uint8_t *)(uintptr_t)EEPROM_START_ADDR;
+}
+
+/** @brief Fresh flash holding a v1 image */
+static uint8_t FlashWithV1(int8_t setTemp, uint8_t corruptCrc)
+{
+    uint8_t *page;
+    uint16_t crc;
+
+    if (HAL_Stub_FlashMap() == NULL)
+    {
+        return 0;
+    }
+    page = Page();
+    page[0] = 0xEF;                     /* 0xDEADBEEF, little endian */
+    page[1] = 0xBE;
+    page[2] = 0xAD;
+    page[3] = 0xDE;
+    page[4] = (uint8_t)setTemp;
+    page[5] = 0x00;                     /* Struct padding, zero in the v1 RAM buffer */
+    crc = EEPROM_CRC16(page, 6);
+    if (corruptCrc)
+    {
+        crc ^= 0x0001;
+    }
+    page[6] = (uint8_t)crc;
+    page[7] = (uint8_t)(crc >> 8);
+    return 1;
+}
+
+/** @brief Current page is a valid v2 image */
+static uint8_t PageIsValidV2(void)
+{
+    const EEPROMData_t *image = (const EEPROMData_t *)Page();
+
+    return image->magic == 0xDEADBEEF && image->version == EEPROM_VERSION &&
+           EEPROM_CRC16((const uint8_t *)image, offsetof(EEPROMData_t, crc)) == image->crc;
+}
+
+/* ========== Test Cases ========== */
+
+static void test_v1_image_migrates(void)
+{
+    const EEPROMData_t *image = (const EEPROMData_t *)(uintptr_t)EEPROM_START_ADDR;
+    int8_t setTemp = 0;
+    int16_t offset, gain;
+
+    CHECK(FlashWithV1(35, 0));
+    CHECK_EQ(EEPROM_Init(), HAL_OK);
+
+    /* Setpoint survives, page rewritten once as v2 */
+    CHECK_EQ(HAL_Stub_FlashErases(), 1);
+    CHECK_EQ(image->version, 2);
+    CHECK(PageIsValidV2());
+    CHECK_EQ(EEPROM_LoadSetpoint(&setTemp), HAL_OK);
+    CHECK_EQ(setTemp, 35);
+
+    /* Calibration table is all free entries */
+    for (uint8_t i = 0; i < EEPROM_MAX_CALIB; i++)
+    {
+        for (uint8_t b = 0; b < 8; b++)
+        {
+            CHECK_EQ(image->calib[i].rom[b], 0xFF);
+        }
+    }
+    CHECK_EQ(EEPROM_LoadCalibration(romA, &offset, &gain), HAL_ERROR);
+    CHECK_EQ(offset, 0);
+    CHECK_EQ(gain, EEPROM_CALIB_GAIN_ONE);
+
+    /* Next boot finds the v2 image and leaves flash alone */
+    CHECK_EQ(EEPROM_Init(), HAL_OK);
+    CHECK_EQ(HAL_Stub_FlashErases(), 1);
+}
+
+static void test_corrupt_v1_uses_defaults(void)
+{
+    int8_t setTemp = 0;
+
+    CHECK(FlashWithV1(35, 1));
+    CHECK_EQ(EEPROM_Init(), HAL_ERROR);
+    CHECK_EQ(HAL_Stub_FlashErases(), 0);            /* Nothing written at boot */
+    CHECK_EQ(EEPROM_LoadSetpoint(&setTemp), HAL_ERROR);
+
+    /* main.c then saves the default setpoint */
+    CHECK_EQ(EEPROM_SaveSetpoint(28), HAL_OK);
+    CHECK(PageIsValidV2());
+    CHECK_EQ(EEPROM_LoadSetpoint(&setTemp), HAL_OK);
+    CHECK_EQ(setTemp, 28);
+}
+
+static void test_calibration_survives_reboot(void)
+{
+    int8_t setTemp = 0;
+    int16_t offset, gain;
+
+    CHECK(FlashWithV1(22, 0));
+    CHECK_EQ(EEPROM_Init(), HAL_OK);
+
+    CHECK_EQ(EEPROM_SaveCalibration(romA, -64, 0x4100), HAL_OK);
+    CHECK_EQ(EEPROM_SaveCalibration(romB, 128, EEPROM_CALIB_GAIN_ONE), HAL_OK);
+    CHECK_EQ(EEPROM_SaveCalibration(romA, -32, 0x4100), HAL_OK);   /* Replaces A */
+    CHECK_EQ(EEPROM_SaveSetpoint(24), HAL_OK);                     /* Keeps the table */
+    CHECK(PageIsValidV2());
+
+    /* Reboot: RAM buffer reloaded from flash */
+    CHECK_EQ(EEPROM_Init(), HAL_OK);
+    CHECK_EQ(EEPROM_LoadSetpoint(&setTemp), HAL_OK);
+    CHECK_EQ(setTemp, 24);
+    CHECK_EQ(EEPROM_LoadCalibration(romA, &offset, &gain), HAL_OK);
+    CHECK_EQ(offset, -32);
+    CHECK_EQ(gain, 0x4100);
+    CHECK_EQ(EEPROM_LoadCalibration(romB, &offset, &gain), HAL_OK);
+    CHECK_EQ(offset, 128);
+    CHECK_EQ(gain, EEPROM_CALIB_GAIN_ONE);
+}
+
+static void test_calibration_table_full(void)
+{
+    uint8_t rom[8] = { 0x28, 0, 0, 0, 0, 0, 0, 0 };
+
+    CHECK(FlashWithV1(28, 0));
+    CHECK_EQ(EEPROM_Init(), HAL_OK);
+    for (uint8_t i = 0; i < EEPROM_MAX_CALIB; i++)
+    {
+        rom[1] = i;
+        CHECK_EQ(EEPROM_SaveCalibration(rom, i, EEPROM_CALIB_GAIN_ONE), HAL_OK);
+    }
+    rom[1] = EEPROM_MAX_CALIB;
+    CHECK_EQ(EEPROM_SaveCalibration(rom, 0, EEPROM_CALIB_GAIN_ONE), HAL_ERROR);
+    CHECK_EQ(EEPROM_SaveCalibration(romA, 0, 0), HAL_ERROR);      /* Gain must be > 0 */
+}
+
+int main(void)
+{
+    int failed = 0;
+
+    RUN(test_v1_image_migrates);
+    RUN(test_corrupt_v1_uses_defaults);
+    RUN(test_calibration_survives_reboot);
+    RUN(test_calibration_table_full);
+    return failed ? 1 : 0;
+}
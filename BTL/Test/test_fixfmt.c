@@ -0,0 +1,141 @@
+/**
+  ******************************************************************************
+  * @file    test_fixfmt.c
+  * @brief   FixFmt_* against a printf reference
+  * @details The sweep covers every Q8.8 value at 0..3 decimals. The
+  *          reference rounds the exact value (|v| * 10^d / 256) half away
+  *          from zero in integer math and prints the result with printf, so
+  *          ties such as 0.125 -> "0.13" are checked exactly (printf's own
+  *          %f would round them to even).
+  ******************************************************************************
+  */
+
+#include "test_common.h"
+#include "fixfmt.h"
+#include <string.h>
+
+#define Q_FRAC_BITS     8
+
+/** @brief Reference text for value / 2^8 at 'decimals', no padding */
+static void Reference(char *out, int32_t value, uint8_t decimals)
+{
+    static const int32_t pow10[4] = { 1, 10, 100, 1000 };
+    int64_t mag = (value < 0) ? -(int64_t)value : value;
+    int64_t scaled = (mag * pow10[decimals] * 2 + (1 << Q_FRAC_BITS)) >> (Q_FRAC_BITS + 1);
+    const char *sign = (value < 0 && scaled != 0) ? "-" : "";
+
+    if (decimals == 0)
+    {
+        sprintf(out, "%s%lld", sign, (long long)scaled);
+    }
+    else
+    {
+        sprintf(out, "%s%lld.%0*lld", sign, (long long)(scaled / pow10[decimals]),
+                decimals, (long long)(scaled % pow10[decimals]));
+    }
+}
+
+/* ========== Test Cases ========== */
+
+static void test_q88_sweep_matches_reference(void)
+{
+    char got[40], want[40];     /* Reference can print up to 27 */
+    uint32_t mismatches = 0;
+
+    for (uint8_t decimals = 0; decimals <= 3; decimals++)
+    {
+        for (int32_t v = INT16_MIN; v <= INT16_MAX; v++)
+        {
+            char *end = FixFmt_Q(got, v, Q_FRAC_BITS, decimals, 0);
+
+            Reference(want, v, decimals);
+            if (strcmp(got, want) != 0 || end != got + strlen(got))
+            {
+                if (mismatches++ < 5)
+                {
+                    fprintf(stderr, "  %d @%u: \"%s\" != \"%s\"\n", (int)v, decimals, got, want);
+                }
+            }
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+}
+
+static void test_rounds_half_away_from_zero(void)
+{
+    char buf[24];
+
+    FixFmt_Q(buf, 128, Q_FRAC_BITS, 0, 0);          /* 0.5 */
+    CHECK(strcmp(buf, "1") == 0);
+    FixFmt_Q(buf, -128, Q_FRAC_BITS, 0, 0);
+    CHECK(strcmp(buf, "-1") == 0);
+    FixFmt_Q(buf, 32, Q_FRAC_BITS, 2, 0);           /* 0.125 */
+    CHECK(strcmp(buf, "0.13") == 0);
+    FixFmt_Q(buf, -32, Q_FRAC_BITS, 2, 0);
+    CHECK(strcmp(buf, "-0.13") == 0);
+    FixFmt_Q(buf, 0x19F8, Q_FRAC_BITS, 1, 0);       /* 25.96875: carry into ipart */
+    CHECK(strcmp(buf, "26.0") == 0);
+}
+
+static void test_no_negative_zero(void)
+{
+    char buf[24];
+
+    FixFmt_Q(buf, -1, Q_FRAC_BITS, 1, 0);           /* -0.0039 */
+    CHECK(strcmp(buf, "0.0") == 0);
+    FixFmt_Q(buf, -12, Q_FRAC_BITS, 1, 5);          /* -0.047 */
+    CHECK(strcmp(buf, "  0.0") == 0);
+    FixFmt_Q(buf, -13, Q_FRAC_BITS, 1, 0);          /* -0.0508 */
+    CHECK(strcmp(buf, "-0.1") == 0);
+}
+
+static void test_width_padding_and_overflow(void)
+{
+    char buf[24];
+    char *end;
+
+    end = FixFmt_Q(buf, 25 * 256 + 64, Q_FRAC_BITS, 2, 7);
+    CHECK(strcmp(buf, "  25.25") == 0);
+    CHECK(end == buf + 7);
+
+    end = FixFmt_Q(buf, -55 * 256, Q_FRAC_BITS, 2, 5);  /* "-55.00" needs 6 */
+    CHECK(strcmp(buf, "*****") == 0);
+    CHECK(end == buf + 5);
+
+    FixFmt_Int(buf, 28, 2);
+    CHECK(strcmp(buf, "28") == 0);
+    FixFmt_Int(buf, 5, 2);
+    CHECK(strcmp(buf, " 5") == 0);
+    FixFmt_Int(buf, 100, 2);
+    CHECK(strcmp(buf, "**") == 0);
+    FixFmt_Int(buf, INT32_MIN, 0);
+    CHECK(strcmp(buf, "-2147483648") == 0);
+
+    end = FixFmt_Str(buf, "--.-", 6);
+    CHECK(strcmp(buf, "  --.-") == 0);
+    CHECK(end == buf + 6);
+}
+
+static void test_chained_calls(void)
+{
+    char buf[32];
+    char *p;
+
+    p = FixFmt_Str(buf, "T:", 0);
+    p = FixFmt_Q(p, -(10 * 256 + 128), Q_FRAC_BITS, 1, 5);
+    p = FixFmt_Str(p, " C S:", 0);
+    FixFmt_Int(p, 28, 2);
+    CHECK(strcmp(buf, "T:-10.5 C S:28") == 0);
+}
+
+int main(void)
+{
+    int failed = 0;
+
+    RUN(test_q88_sweep_matches_reference);
+    RUN(test_rounds_half_away_from_zero);
+    RUN(test_no_negative_zero);
+    RUN(test_width_padding_and_overflow);
+    RUN(test_chained_calls);
+    return failed ? 1 : 0;
+}
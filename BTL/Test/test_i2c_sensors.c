@@ -0,0 +1,195 @@
+/**
+  ******************************************************************************
+  * @file    test_i2c_sensors.c
+  * @brief   lm75.c and sht3x.c through sensor.h against fake I2C devices
+  ******************************************************************************
+  */
+
+#include "test_common.h"
+#include "i2c_fakes.h"
+#include "lm75.h"
+#include "sht3x.h"
+
+I2C_HandleTypeDef hi2c1;
+
+#define LCD_ADDR        (0x27 << 1)     /* Owns the bus during a DMA flush */
+
+static HAL_StatusTypeDef NullWrite(void *ctx, const uint8_t *data, uint16_t size)
+{
+    (void)ctx;
+    (void)data;
+    (void)size;
+    return HAL_OK;
+}
+
+static const HAL_Stub_I2cDevice_t lcdSink = { NULL, NullWrite, NULL };
+
+/** @brief Drive the sensor.h cycle until a reading arrives (10 ms poll) */
+static uint8_t PollReading(Sensor_t *sensor, uint32_t maxMs)
+{
+    uint32_t end = HAL_GetTick() + maxMs;
+
+    while (HAL_GetTick() < end)
+    {
+        if (Sensor_Poll(sensor, HAL_GetTick()))
+        {
+            return 1;
+        }
+        HAL_Delay(10);
+    }
+    return 0;
+}
+
+static int32_t Abs32(int32_t v)
+{
+    return (v < 0) ? -v : v;
+}
+
+/* ========== LM75 ========== */
+
+static void test_lm75_reading(void)
+{
+    FakeLM75_t fake = { 0 };
+    LM75_t dev = { &hi2c1, LM75_ADDR_DEFAULT, SENSOR_HEALTH_ABSENT };
+    Sensor_t sensor = SENSOR_ENTRY(&LM75_SensorOps, &dev, 500, 100, 0);
+
+    HAL_Stub_Reset();
+    FakeLM75_Attach(&fake, LM75_ADDR_DEFAULT);
+    Sensor_Init(&sensor, HAL_GetTick());
+
+    fake.temp = TEMP_FROM_INT(25) + TEMP_ONE / 2 + 10;  /* Below 0.5 degC is dropped */
+    CHECK(PollReading(&sensor, 1000));
+    CHECK_EQ(sensor.temp, TEMP_FROM_INT(25) + TEMP_ONE / 2);
+    CHECK_EQ(fake.pointer, LM75_REG_TEMP);
+    CHECK_EQ(Sensor_Health(&sensor), SENSOR_HEALTH_OK);
+
+    fake.temp = TEMP_FROM_INT(-10) - TEMP_ONE / 2;
+    CHECK(PollReading(&sensor, 1000));
+    CHECK_EQ(sensor.temp, TEMP_FROM_INT(-10) - TEMP_ONE / 2);
+}
+
+static void test_lm75_absent(void)
+{
+    LM75_t dev = { &hi2c1, LM75_ADDR_DEFAULT, SENSOR_HEALTH_OK };
+    Sensor_t sensor = SENSOR_ENTRY(&LM75_SensorOps, &dev, 500, 100, 0);
+
+    HAL_Stub_Reset();
+    Sensor_Init(&sensor, HAL_GetTick());
+    CHECK(!PollReading(&sensor, 1000));
+    CHECK_EQ(Sensor_Health(&sensor), SENSOR_HEALTH_ABSENT);
+    CHECK(!sensor.valid);
+}
+
+/* ========== SHT3x ========== */
+
+static void test_sht3x_reading(void)
+{
+    FakeSHT3x_t fake = { 0 };
+    SHT3x_t dev = { &hi2c1, SHT3X_ADDR_DEFAULT, 0, 0, SENSOR_HEALTH_ABSENT };
+    Sensor_t sensor = SENSOR_ENTRY(&SHT3x_SensorOps, &dev, 1000, 100, 0);
+
+    HAL_Stub_Reset();
+    FakeSHT3x_Attach(&fake, SHT3X_ADDR_DEFAULT);
+    FakeSHT3x_Set(&fake, 2345, 5500);
+    Sensor_Init(&sensor, HAL_GetTick());
+
+    CHECK(PollReading(&sensor, 1000));
+    CHECK(Abs32(sensor.temp - (2345 * TEMP_ONE) / 100) <= 1);
+    CHECK(Abs32(dev.humidity - 55 * 256) <= 1);
+    CHECK_EQ(fake.commands, 1);
+    CHECK_EQ(fake.nacks, 0);            /* ready() waited out the conversion */
+    CHECK_EQ(Sensor_Health(&sensor), SENSOR_HEALTH_OK);
+
+    FakeSHT3x_Set(&fake, -4000, 0);
+    CHECK(PollReading(&sensor, 2000));
+    CHECK(Abs32(sensor.temp - TEMP_FROM_INT(-40)) <= 1);
+}
+
+static void test_sht3x_crc_error(void)
+{
+    FakeSHT3x_t fake = { 0 };
+    SHT3x_t dev = { &hi2c1, SHT3X_ADDR_DEFAULT, 0, 0, SENSOR_HEALTH_ABSENT };
+    Sensor_t sensor = SENSOR_ENTRY(&SHT3x_SensorOps, &dev, 1000, 100, 0);
+
+    HAL_Stub_Reset();
+    FakeSHT3x_Attach(&fake, SHT3X_ADDR_DEFAULT);
+    FakeSHT3x_Set(&fake, 2500, 5000);
+    fake.corruptCrc = 1;
+    Sensor_Init(&sensor, HAL_GetTick());
+
+    CHECK(!PollReading(&sensor, 1000));
+    CHECK_EQ(Sensor_Health(&sensor), SENSOR_HEALTH_ERROR);
+    CHECK(!sensor.valid);
+}
+
+static void test_sht3x_top_of_range_saturates(void)
+{
+    FakeSHT3x_t fake = { 0 };
+    SHT3x_t dev = { &hi2c1, SHT3X_ADDR_DEFAULT, 0, 0, SENSOR_HEALTH_ABSENT };
+    Sensor_t sensor = SENSOR_ENTRY(&SHT3x_SensorOps, &dev, 1000, 100, 0);
+
+    HAL_Stub_Reset();
+    FakeSHT3x_Attach(&fake, SHT3X_ADDR_DEFAULT);
+    Sensor_Init(&sensor, HAL_GetTick());
+
+    FakeSHT3x_Set(&fake, 12750, 0);     /* Still representable */
+    CHECK(PollReading(&sensor, 2000));
+    CHECK(Abs32(sensor.temp - (12750 * TEMP_ONE) / 100) <= 1);
+
+    fake.rawT = 0xFFFF;                 /* 130 degC */
+    CHECK(PollReading(&sensor, 2000));
+    CHECK_EQ(sensor.temp, INT16_MAX);
+}
+
+/* ========== Shared Bus ========== */
+
+static void test_shared_bus_busy(void)
+{
+    FakeSHT3x_t fake = { 0 };
+    FakeLM75_t lm = { 0 };
+    SHT3x_t dev = { &hi2c1, SHT3X_ADDR_DEFAULT, 0, 0, SENSOR_HEALTH_ABSENT };
+    LM75_t lmDev = { &hi2c1, LM75_ADDR_DEFAULT, SENSOR_HEALTH_ABSENT };
+    Sensor_t sensor = SENSOR_ENTRY(&SHT3x_SensorOps, &dev, 1000, 100, 0);
+    Sensor_t lmSensor = SENSOR_ENTRY(&LM75_SensorOps, &lmDev, 500, 100, 0);
+    uint8_t frame[16] = { 0 };
+
+    HAL_Stub_Reset();
+    HAL_Stub_I2cAttach(LCD_ADDR, &lcdSink);
+    FakeSHT3x_Attach(&fake, SHT3X_ADDR_DEFAULT);
+    FakeLM75_Attach(&lm, LM75_ADDR_DEFAULT);
+    FakeSHT3x_Set(&fake, 2100, 4000);
+    lm.temp = TEMP_FROM_INT(21);
+    Sensor_Init(&sensor, HAL_GetTick());
+    Sensor_Init(&lmSensor, HAL_GetTick());
+
+    /* LCD frame on the wire: start() backs off, nothing reaches the device */
+    CHECK_EQ(HAL_I2C_Master_Transmit_DMA(&hi2c1, LCD_ADDR, frame, sizeof(frame)), HAL_OK);
+    for (uint8_t i = 0; i < 5; i++)
+    {
+        CHECK_EQ(Sensor_Poll(&sensor, HAL_GetTick()), 0);
+        CHECK_EQ(Sensor_Poll(&lmSensor, HAL_GetTick()), 0);
+        HAL_Delay(10);
+    }
+    CHECK_EQ(fake.commands, 0);
+    CHECK_EQ(lm.reads, 0);
+    CHECK_EQ(sensor.state, SENSOR_STATE_IDLE);      /* Retried, not failed */
+    CHECK_EQ(HAL_Stub_I2cBusyReturns(), 0);         /* Never hit HAL_BUSY */
+
+    HAL_Stub_I2cDmaComplete(&hi2c1);
+    CHECK(PollReading(&sensor, 1000));
+    CHECK(PollReading(&lmSensor, 1000));
+    CHECK_EQ(lmSensor.temp, TEMP_FROM_INT(21));
+}
+
+int main(void)
+{
+    int failed = 0;
+
+    RUN(test_lm75_reading);
+    RUN(test_lm75_absent);
+    RUN(test_sht3x_reading);
+    RUN(test_sht3x_crc_error);
+    RUN(test_sht3x_top_of_range_saturates);
+    RUN(test_shared_bus_busy);
+    return failed ? 1 : 0;
+}
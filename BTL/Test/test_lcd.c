@@ -0,0 +1,412 @@
+/**
+  ******************************************************************************
+  * @file    test_lcd.c
+  * @brief   liquidcrystal_i2c.c against an HD44780 + PCF8574 model
+  * @details The model sits on the stub I2C bus at DEVICE_ADDR and decodes
+  *          every expander byte like the real backpack: P0 = RS, P1 = RW,
+  *          P2 = E, P3 = backlight, P4..P7 = D4..D7. The HD44780 latches on
+  *          the falling edge of E, starts in 8-bit mode and pairs nibbles
+  *          after Function Set with DL = 0. DDRAM and CGRAM are kept so the
+  *          tests compare what the panel would show. With rwStrap set the
+  *          module models a backpack whose RW is tied to GND: P1 goes
+  *          nowhere, every E fall is a write (a busy-flag read clocks in
+  *          D7..D4 = 1111), and reads return the expander's own pins.
+  ******************************************************************************
+  */
+
+#include "test_common.h"
+#include "liquidcrystal_i2c.h"
+#include <string.h>
+
+I2C_HandleTypeDef hi2c1;
+
+/* ========== HD44780 + PCF8574 Model ========== */
+#define PCF_RS      0x01
+#define PCF_RW      0x02
+#define PCF_E       0x04
+
+static struct {
+    uint8_t ddram[128];
+    uint8_t cgram[64];
+    uint8_t addr;
+    uint8_t cgMode;         /* 1: address counter points into CGRAM */
+    uint8_t fourBit;
+    uint8_t half;           /* 4-bit mode: high nibble received */
+    uint8_t high;
+    uint8_t port;           /* Last byte written to the expander */
+    uint16_t busyReads;     /* Busy-flag reads that still return BF = 1 */
+    uint8_t rwStrap;        /* 1: RW tied to GND on the module */
+    uint32_t strayWrites;   /* E falls with P1 high that the strap turned into writes */
+    uint32_t reads;
+    uint32_t writes;        /* I2C write transactions */
+} lcd;
+
+static void LcdExecute(uint8_t rs, uint8_t b)
+{
+    if (rs)
+    {
+        if (lcd.cgMode)
+        {
+            lcd.cgram[lcd.addr & 0x3F] = b;
+        }
+        else
+        {
+            lcd.ddram[lcd.addr & 0x7F] = b;
+        }
+        lcd.addr++;
+    }
+    else if (b & 0x80)
+    {
+        lcd.addr = b & 0x7F;
+        lcd.cgMode = 0;
+    }
+    else if (b & 0x40)
+    {
+        lcd.addr = b & 0x3F;
+        lcd.cgMode = 1;
+    }
+    else if ((b & 0xE0) == 0x20)
+    {
+        lcd.fourBit = !(b & 0x10);
+    }
+    else if (b == 0x01)
+    {
+        memset(lcd.ddram, ' ', sizeof(lcd.ddram));
+        lcd.addr = 0;
+        lcd.cgMode = 0;
+    }
+    else if ((b & 0xFE) == 0x02)
+    {
+        lcd.addr = 0;
+        lcd.cgMode = 0;
+    }
+}
+
+static void LcdPort(uint8_t v)
+{
+    uint8_t fall = (lcd.port & PCF_E) && !(v & PCF_E);
+
+    lcd.port = v;
+    if (!fall)
+    {
+        return;
+    }
+    if (v & PCF_RW)
+    {
+        if (!lcd.rwStrap)
+        {
+            return;     /* Reads (RW = 1) do not clock data in */
+        }
+        lcd.strayWrites++;
+    }
+    if (!lcd.fourBit)
+    {
+        uint8_t was = lcd.fourBit;
+        LcdExecute(v & PCF_RS, v & 0xF0);
+        if (!was && lcd.fourBit)
+        {
+            lcd.half = 0;
+        }
+    }
+    else if (!lcd.half)
+    {
+        lcd.high = v & 0xF0;
+        lcd.half = 1;
+    }
+    else
+    {
+        lcd.half = 0;
+        LcdExecute(v & PCF_RS, (uint8_t)(lcd.high | (v >> 4)));
+    }
+}
+
+static HAL_StatusTypeDef LcdWrite(void *ctx, const uint8_t *data, uint16_t size)
+{
+    (void)ctx;
+    lcd.writes++;
+    for (uint16_t i = 0; i < size; i++)
+    {
+        LcdPort(data[i]);
+    }
+    return HAL_OK;
+}
+
+/* PCF8574 read: pins as driven, with BF on D7 while RW/E are high */
+static HAL_StatusTypeDef LcdRead(void *ctx, uint8_t *data, uint16_t size)
+{
+    (void)ctx;
+    lcd.reads++;
+    for (uint16_t i = 0; i < size; i++)
+    {
+        if (lcd.rwStrap)
+        {
+            data[i] = lcd.port;     /* Controller never drives the bus */
+            continue;
+        }
+        uint8_t busy = lcd.busyReads > 0;
+        if (busy)
+        {
+            lcd.busyReads--;
+        }
+        data[i] = (uint8_t)((lcd.port & 0x0F) | (busy ? 0x80 : 0x00) | (lcd.addr & 0x70));
+    }
+    return HAL_OK;
+}
+
+static const HAL_Stub_I2cDevice_t lcdDevice = { NULL, LcdWrite, LcdRead };
+
+/* ========== Helpers ========== */
+
+static void LcdSetup(void)
+{
+    HAL_Stub_Reset();
+    memset(&lcd, 0, sizeof(lcd));
+    memset(lcd.ddram, '?', sizeof(lcd.ddram));
+    HAL_Stub_I2cAttach(DEVICE_ADDR, &lcdDevice);
+    lcdInit();
+}
+
+static uint8_t RowIs(uint8_t row, const char *text)
+{
+    return memcmp(&lcd.ddram[row ? 0x40 : 0x00], text, strlen(text)) == 0;
+}
+
+static void DrawFrame(const char *line0, const char *line1)
+{
+    lcdFbClear();
+    lcdFbWrite(0, 0, line0);
+    lcdFbWrite(1, 0, line1);
+}
+
+/** @brief Panel contents after init, clear and one frame with a glyph */
+static void RunStartup(uint8_t rwStrap, uint8_t *ddram, uint8_t *cgram)
+{
+    uint8_t bitmap[8];
+    char line[8] = "T:25.1";
+
+    HAL_Stub_Reset();
+    memset(&lcd, 0, sizeof(lcd));
+    memset(lcd.ddram, '?', sizeof(lcd.ddram));
+    lcd.rwStrap = rwStrap;
+    HAL_Stub_I2cAttach(DEVICE_ADDR, &lcdDevice);
+    lcdInit();
+    lcdClear();
+
+    memset(bitmap, 0x0E, sizeof(bitmap));
+    line[6] = lcdGlyph(LCD_GLYPH_USER, bitmap);
+    line[7] = '\0';
+    DrawFrame(line, "M:NORMAL F:OFF");
+    lcdFlush();
+    memcpy(ddram, lcd.ddram, sizeof(lcd.ddram));
+    memcpy(cgram, lcd.cgram, sizeof(lcd.cgram));
+}
+
+/* ========== Test Cases ========== */
+
+static void test_init_and_flush(void)
+{
+    LcdSetup();
+    CHECK(lcd.fourBit);
+    CHECK(RowIs(0, "                "));
+
+    DrawFrame("T:25.1 C S:28", "M:NORMAL F:OFF");
+    CHECK(lcdFlush() > 0);
+    CHECK(RowIs(0, "T:25.1 C S:28   "));
+    CHECK(RowIs(1, "M:NORMAL F:OFF  "));
+}
+
+static void test_flush_sends_only_changes(void)
+{
+    uint32_t writes;
+
+    LcdSetup();
+    DrawFrame("T:25.1 C S:28", "M:NORMAL F:OFF");
+    lcdFlush();
+
+    writes = lcd.writes;
+    DrawFrame("T:25.1 C S:28", "M:NORMAL F:OFF");
+    CHECK_EQ(lcdFlush(), 0);
+    CHECK_EQ(lcd.writes, writes);
+
+    /* One digit and one word: two runs, one I2C transaction */
+    DrawFrame("T:25.2 C S:28", "M:NORMAL F:ON ");
+    CHECK(lcdFlush() < 6 * 8);
+    CHECK_EQ(lcd.writes, writes + 1);
+    CHECK(RowIs(0, "T:25.2 C S:28"));
+    CHECK(RowIs(1, "M:NORMAL F:ON "));
+}
+
+static void test_async_flush(void)
+{
+    LcdSetup();
+    DrawFrame("T:26.0 C S:28", "M:NORMAL F:OFF");
+    CHECK(lcdFlushAsync() > 0);
+    CHECK(lcdBusy());
+    CHECK(RowIs(0, "        "));            /* Still on the wire */
+
+    lcdFbWrite(0, 2, "27");
+    CHECK_EQ(lcdFlushAsync(), 0);           /* Previous frame in flight */
+
+    HAL_Stub_I2cDmaComplete(&hi2c1);
+    CHECK(!lcdBusy());
+    CHECK(RowIs(0, "T:26.0 C S:28"));
+
+    CHECK(lcdFlushAsync() > 0);
+    HAL_Stub_I2cDmaComplete(&hi2c1);
+    CHECK(RowIs(0, "T:27.0 C S:28"));
+}
+
+static void test_glyph_cache(void)
+{
+    uint8_t bitmap[8];
+    char line[LCD_GLYPH_SLOTS + 2];
+    uint32_t writes;
+
+    LcdSetup();
+
+    /* Nine glyphs in one frame: eight slots, the ninth gets the fallback */
+    for (uint8_t g = 0; g <= LCD_GLYPH_SLOTS; g++)
+    {
+        memset(bitmap, g, sizeof(bitmap));
+        line[g] = lcdGlyph(LCD_GLYPH_USER + g, bitmap);
+    }
+    line[LCD_GLYPH_SLOTS + 1] = '\0';
+    CHECK_EQ(line[LCD_GLYPH_SLOTS], LCD_GLYPH_FALLBACK);
+
+    writes = lcd.writes;
+    DrawFrame(line, "");
+    lcdFlush();
+    CHECK_EQ(lcd.writes, writes + 1);       /* CGRAM and text in one transaction */
+    for (uint8_t s = 0; s < LCD_GLYPH_SLOTS; s++)
+    {
+        CHECK_EQ(lcd.ddram[s], LCD_GLYPH_CODE(s));
+        CHECK_EQ(lcd.cgram[s * 8 + 7], s);
+    }
+
+    /* Same glyphs again: nothing to send */
+    for (uint8_t g = 0; g < LCD_GLYPH_SLOTS; g++)
+    {
+        memset(bitmap, g, sizeof(bitmap));
+        lcdGlyph(LCD_GLYPH_USER + g, bitmap);
+    }
+    DrawFrame(line, "");
+    CHECK_EQ(lcdFlush(), 0);
+
+    /* Changed bitmap: only that slot is re-sent */
+    memset(bitmap, 0x1F, sizeof(bitmap));
+    CHECK_EQ(lcdGlyph(LCD_GLYPH_USER + 3, bitmap), LCD_GLYPH_CODE(3));
+    CHECK(lcdFlush() > 0);
+    CHECK_EQ(lcd.cgram[3 * 8], 0x1F);
+    CHECK_EQ(lcd.cgram[2 * 8], 2);
+
+    /* After the flush the LRU slot can be evicted */
+    memset(bitmap, 9, sizeof(bitmap));
+    CHECK(lcdGlyph(LCD_GLYPH_USER + 9, bitmap) != LCD_GLYPH_FALLBACK);
+}
+
+static void test_async_timeout_releases_bus(void)
+{
+    LcdSetup();
+    DrawFrame("T:26.0 C S:28", "M:NORMAL F:OFF");
+    CHECK(lcdFlushAsync() > 0);
+
+    /* DMA never completes: the next blocking call aborts, waits, redraws */
+    lcdClear();
+    CHECK(!lcdBusy());
+    CHECK_EQ(HAL_Stub_I2cBusyReturns(), 0);
+    CHECK(RowIs(0, "                "));
+
+    CHECK(lcdFlush() > 0);
+    CHECK(RowIs(0, "T:26.0 C S:28"));
+    CHECK(RowIs(1, "M:NORMAL F:OFF"));
+}
+
+static void test_dropped_frame_resends_glyphs(void)
+{
+    uint8_t bitmap[8];
+    char line[2] = { 0, 0 };
+
+    LcdSetup();
+    memset(bitmap, 0x15, sizeof(bitmap));
+    line[0] = lcdGlyph(LCD_GLYPH_USER, bitmap);
+    DrawFrame(line, "");
+    CHECK(lcdFlushAsync() > 0);
+    HAL_Stub_I2cDmaError(&hi2c1);
+    CHECK(!lcdBusy());
+    CHECK(lcd.cgram[0] != 0x15);                    /* Frame never arrived */
+
+    /* Same glyph, same text: the retry still carries the CGRAM upload */
+    line[0] = lcdGlyph(LCD_GLYPH_USER, bitmap);
+    DrawFrame(line, "");
+    CHECK(lcdFlushAsync() > 0);
+    HAL_Stub_I2cDmaComplete(&hi2c1);
+    CHECK_EQ(lcd.cgram[0], 0x15);
+    CHECK_EQ(lcd.cgram[7], 0x15);
+    CHECK_EQ(lcd.ddram[0], LCD_GLYPH_CODE(0));
+
+    /* DMA refused at start: same recovery */
+    memset(bitmap, 0x0A, sizeof(bitmap));
+    line[0] = lcdGlyph(LCD_GLYPH_USER, bitmap);
+    DrawFrame(line, "");
+    HAL_Stub_I2cFailNextDma();
+    lcdFlushAsync();
+    CHECK(!lcdBusy());
+    CHECK_EQ(lcd.cgram[0], 0x15);
+    CHECK(lcdFlushAsync() > 0);
+    HAL_Stub_I2cDmaComplete(&hi2c1);
+    CHECK_EQ(lcd.cgram[0], 0x0A);
+}
+
+static void test_busy_flag_poll(void)
+{
+    uint32_t reads;
+
+    LcdSetup();
+    CHECK(lcd.reads > 0);                   /* Init polled BF */
+
+    reads = lcd.reads;
+    lcd.busyReads = 3;
+    lcdClear();
+    CHECK_EQ(lcd.reads - reads, 4);         /* Three busy, one ready */
+    CHECK(RowIs(0, "                "));
+
+    /* A panel that never clears BF falls back to delays */
+    lcd.busyReads = 0xFFFF;
+    lcdClear();
+    reads = lcd.reads;
+    lcdClear();
+    CHECK_EQ(lcd.reads, reads);
+}
+
+static void test_rw_strapped_panel(void)
+{
+    uint8_t ddram[2][128], cgram[2][64];
+
+    /* RW tied to GND: each BF read pulse writes 0xF to the controller */
+    RunStartup(1, ddram[1], cgram[1]);
+    CHECK(lcd.reads <= 1);                  /* Strap detected once at init */
+    CHECK(lcd.strayWrites <= 2);            /* That one read: Set DDRAM 0x7F */
+
+    /* Same panel contents and CGRAM as a correctly wired module */
+    RunStartup(0, ddram[0], cgram[0]);
+    CHECK_EQ(lcd.strayWrites, 0);
+    CHECK(lcd.reads > 1);                   /* Wired panel: polling re-enabled */
+    CHECK(memcmp(ddram[0], ddram[1], sizeof(ddram[0])) == 0);
+    CHECK(memcmp(cgram[0], cgram[1], sizeof(cgram[0])) == 0);
+    CHECK(memcmp(&ddram[1][0x40], "M:NORMAL F:OFF", 14) == 0);
+}
+
+int main(void)
+{
+    int failed = 0;
+
+    RUN(test_init_and_flush);
+    RUN(test_flush_sends_only_changes);
+    RUN(test_async_flush);
+    RUN(test_glyph_cache);
+    RUN(test_async_timeout_releases_bus);
+    RUN(test_dropped_frame_resends_glyphs);
+    RUN(test_busy_flag_poll);
+    RUN(test_rw_strapped_panel);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+/**
+  ******************************************************************************
+  * @file    test_onewire_multi.c
+  * @brief   onewire_multi.c against several simulated 1-Wire segments
+  * @details Runs the parallel engine through the OneWire_Multi_Phy* hooks of
+  *          onewire_sim.c with a different DS18B20 on three GPIOB segments
+  *          and the other three segments of ONEWIRE_MULTI_MASK left empty.
+  *          Checks the per-segment presence mask, the transposed reads and
+  *          writes, and the interrupt masking per slot.
+  ******************************************************************************
+  */
+
+#include "test_common.h"
+#include "onewire_sim.h"
+#include "onewire_multi.h"
+#include "DS18B20.h"
+#include "eeprom.h"
+#include <string.h>
+
+#define SEG_A           0
+#define SEG_B           9
+#define SEG_C           14
+#define SEGS_PRESENT    ((1U << SEG_A) | (1U << SEG_B) | (1U << SEG_C))
+#define TEMP_A_Q4       ((int16_t)(25 * 16 + 1))    /* 25.0625 degC */
+#define TEMP_B_Q4       ((int16_t)(-10 * 16 - 8))   /* -10.5 degC */
+#define TEMP_C_Q4       ((int16_t)(85 * 16))
+
+/* No flash on the host: every sensor is uncalibrated */
+HAL_StatusTypeDef EEPROM_LoadCalibration(const uint8_t *rom, int16_t *pOffset, int16_t *pGain)
+{
+    (void)rom;
+    *pOffset = 0;
+    *pGain = EEPROM_CALIB_GAIN_ONE;
+    return HAL_ERROR;
+}
+
+HAL_StatusTypeDef EEPROM_SaveCalibration(const uint8_t *rom, int16_t offset, int16_t gain)
+{
+    (void)rom;
+    (void)offset;
+    (void)gain;
+    return HAL_ERROR;
+}
+
+/* ========== Helpers ========== */
+
+static OwSimDevice_t *dev[3];
+static OwSimDevice_t *dq;
+
+static void BusInit(void)
+{
+    HAL_Stub_Reset();
+    OneWireSim_Init(0);
+    dev[0] = OneWireSim_AddSegmentDevice(SEG_A, 0x0000A1B2C3D4E5ULL, TEMP_A_Q4, 0);
+    dev[1] = OneWireSim_AddSegmentDevice(SEG_B, 0x00001122334455ULL, TEMP_B_Q4, 0);
+    dev[2] = OneWireSim_AddSegmentDevice(SEG_C, 0x0000600D5EED00ULL, TEMP_C_Q4, 0);
+    dq = OneWireSim_AddDevice(0x00000000000042ULL, 0, 0);   /* Must never be touched */
+    OneWire_Multi_Init();
+}
+
+static int16_t RawTemp(const uint8_t *sp)
+{
+    return (int16_t)(sp[1] << 8 | sp[0]);
+}
+
+/* ========== Test Cases ========== */
+
+static void test_presence_per_segment(void)
+{
+    BusInit();
+    CHECK_EQ(OneWire_Multi_Reset(), SEGS_PRESENT);
+
+    dev[1]->present = 0;    /* Unplug segment B */
+    CHECK_EQ(OneWire_Multi_Reset(), SEGS_PRESENT & ~(1U << SEG_B));
+    CHECK_EQ(dq->slotErrors, 0);
+}
+
+static void test_scratchpads_per_segment(void)
+{
+    uint8_t sp[ONEWIRE_MULTI_SEGMENTS][9];
+
+    BusInit();
+    CHECK_EQ(OneWire_Multi_StartConversion(), SEGS_PRESENT);
+    HAL_Delay(DS18B20_CONV_TIME_MS);
+
+    memset(sp, 0, sizeof(sp));
+    CHECK_EQ(OneWire_Multi_ReadScratchpads(sp), SEGS_PRESENT);
+    CHECK_EQ(RawTemp(sp[SEG_A]), TEMP_A_Q4);
+    CHECK_EQ(RawTemp(sp[SEG_B]), TEMP_B_Q4);
+    CHECK_EQ(RawTemp(sp[SEG_C]), TEMP_C_Q4);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        CHECK_EQ(dev[i]->conversions, 1);
+        CHECK_EQ(dev[i]->slotErrors, 0);
+    }
+
+    /* Empty segments read the idle bus */
+    CHECK_EQ(sp[1][0], 0xFF);
+    CHECK_EQ(sp[15][8], 0xFF);
+
+    /* The single-bus DS18B20 pin is not part of the mask */
+    CHECK_EQ(dq->conversions, 0);
+}
+
+static void test_write_bytes_per_segment(void)
+{
+    uint8_t th[ONEWIRE_MULTI_SEGMENTS] = {0};
+    uint8_t tl[ONEWIRE_MULTI_SEGMENTS] = {0};
+    uint8_t cfg[ONEWIRE_MULTI_SEGMENTS] = {0};
+    uint8_t sp[ONEWIRE_MULTI_SEGMENTS][9];
+
+    th[SEG_A] = 0x1E; tl[SEG_A] = 0x05; cfg[SEG_A] = 0x1F;  /* 9 bit */
+    th[SEG_B] = 0x7F; tl[SEG_B] = 0x80; cfg[SEG_B] = 0x3F;  /* 10 bit */
+    th[SEG_C] = 0xA5; tl[SEG_C] = 0x5A; cfg[SEG_C] = 0x7F;  /* 12 bit */
+
+    BusInit();
+    CHECK_EQ(OneWire_Multi_Reset(), SEGS_PRESENT);
+    OneWire_Multi_WriteByte(0xCC);  /* Skip ROM */
+    OneWire_Multi_WriteByte(0x4E);  /* Write Scratchpad */
+    OneWire_Multi_WriteBytes(th);
+    OneWire_Multi_WriteBytes(tl);
+    OneWire_Multi_WriteBytes(cfg);
+
+    CHECK_EQ(OneWire_Multi_ReadScratchpads(sp), SEGS_PRESENT);
+    for (uint8_t seg = 0; seg < ONEWIRE_MULTI_SEGMENTS; seg++)
+    {
+        if (SEGS_PRESENT & (1U << seg))
+        {
+            CHECK_EQ(sp[seg][2], th[seg]);
+            CHECK_EQ(sp[seg][3], tl[seg]);
+            CHECK_EQ(sp[seg][4], cfg[seg]);
+        }
+    }
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        CHECK_EQ(dev[i]->slotErrors, 0);
+    }
+}
+
+static void test_irq_masked_per_slot_only(void)
+{
+    uint8_t sp[ONEWIRE_MULTI_SEGMENTS][9];
+    uint8_t column[ONEWIRE_MULTI_SEGMENTS];
+
+    BusInit();
+    HAL_Stub_MaskMaxNs = 0;
+    CHECK_EQ(OneWire_Multi_StartConversion(), SEGS_PRESENT);
+    HAL_Delay(DS18B20_CONV_TIME_MS);
+    CHECK_EQ(OneWire_Multi_ReadScratchpads(sp), SEGS_PRESENT);
+
+    /* Longest mask is the presence window, never a whole byte */
+    CHECK(HAL_Stub_MaskMaxNs >= DS18B20_T_PRESENCE_US * 1000ULL);
+    CHECK(HAL_Stub_MaskMaxNs <= 76 * 1000ULL);
+    CHECK_EQ(HAL_Stub_Primask, 0);
+
+    /* Inside a slot: falling edge to sample only, not the 60 us low */
+    CHECK_EQ(OneWire_Multi_Reset(), SEGS_PRESENT);
+    OneWire_Multi_WriteByte(0xCC);
+    OneWire_Multi_WriteByte(0xBE);
+    HAL_Stub_MaskMaxNs = 0;
+    OneWire_Multi_ReadBytes(column);
+    CHECK_EQ(column[SEG_A], (uint8_t)TEMP_A_Q4);
+    CHECK(HAL_Stub_MaskMaxNs <= 11 * 1000ULL);
+    CHECK_EQ(HAL_Stub_Primask, 0);
+}
+
+int main(void)
+{
+    int failed = 0;
+
+    RUN(test_presence_per_segment);
+    RUN(test_scratchpads_per_segment);
+    RUN(test_write_bytes_per_segment);
+    RUN(test_irq_masked_per_slot_only);
+    return failed ? 1 : 0;
+}
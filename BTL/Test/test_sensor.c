@@ -0,0 +1,186 @@
+/**
+  ******************************************************************************
+  * @file    test_sensor.c
+  * @brief   sensor.c scheduling and oversampling against a scripted driver
+  * @details The fake driver converts instantly and returns readings from a
+  *          script, one per cycle; a script entry can fail the read or never
+  *          become ready. Checks the 2^shift decimation (rounded mean, one
+  *          output per 2^shift readings) and that a failed read or timeout
+  *          drops the partial sum.
+  ******************************************************************************
+  */
+
+#include "test_common.h"
+#include "sensor.h"
+
+#define LSB             (TEMP_ONE / 16)     /* DS18B20 12-bit step in Q8.8 */
+#define PERIOD_MS       500
+#define TIMEOUT_MS      100
+#define STEP_READ_FAIL  INT16_MIN           /* Script: read() returns HAL_ERROR */
+#define STEP_NO_READY   (INT16_MIN + 1)     /* Script: conversion never completes */
+
+/* ========== Scripted Driver ========== */
+
+typedef struct {
+    const Temp_t *script;
+    uint8_t length;
+    uint8_t next;
+    uint8_t reads;
+} FakeSensor_t;
+
+static HAL_StatusTypeDef FakeStart(void *ctx)
+{
+    (void)ctx;
+    return HAL_OK;
+}
+
+static uint8_t FakeReady(void *ctx)
+{
+    FakeSensor_t *f = ctx;
+
+    if (f->script[f->next] == STEP_NO_READY)
+    {
+        f->next++;      /* Consumed by the timeout */
+        return 0;
+    }
+    return 1;
+}
+
+static HAL_StatusTypeDef FakeRead(void *ctx, Temp_t *pTemp)
+{
+    FakeSensor_t *f = ctx;
+    Temp_t t = f->script[f->next++];
+
+    f->reads++;
+    if (t == STEP_READ_FAIL)
+    {
+        return HAL_ERROR;
+    }
+    *pTemp = t;
+    return HAL_OK;
+}
+
+static SensorHealth_t FakeHealth(void *ctx)
+{
+    (void)ctx;
+    return SENSOR_HEALTH_OK;
+}
+
+static const SensorOps_t FakeOps = { "fake", 4, FakeStart, FakeReady, FakeRead, FakeHealth };
+
+/**
+ * @brief Run one full start/ready/read cycle per script entry
+ * @param out: Outputs, in order
+ * @retval Number of outputs
+ */
+static uint8_t RunScript(Sensor_t *sensor, FakeSensor_t *fake, Temp_t *out)
+{
+    uint32_t now = 0;
+    uint8_t count = 0;
+
+    Sensor_Init(sensor, now);
+    while (fake->next < fake->length)
+    {
+        (void)Sensor_Poll(sensor, now);                 /* start */
+        now += (fake->script[fake->next] == STEP_NO_READY) ? TIMEOUT_MS : 10;
+        if (Sensor_Poll(sensor, now))                   /* ready + read, or timeout */
+        {
+            out[count++] = sensor->temp;
+        }
+        now += PERIOD_MS;
+    }
+    return count;
+}
+
+/* ========== Test Cases ========== */
+
+static void test_no_oversampling_passes_through(void)
+{
+    static const Temp_t script[] = { TEMP_FROM_INT(25), TEMP_FROM_INT(25) + LSB, STEP_READ_FAIL, TEMP_FROM_INT(26) };
+    FakeSensor_t fake = { script, 4, 0, 0 };
+    Sensor_t sensor = SENSOR_ENTRY(&FakeOps, &fake, PERIOD_MS, TIMEOUT_MS, 0);
+    Temp_t out[4];
+
+    CHECK_EQ(RunScript(&sensor, &fake, out), 3);
+    CHECK_EQ(out[0], TEMP_FROM_INT(25));
+    CHECK_EQ(out[1], TEMP_FROM_INT(25) + LSB);
+    CHECK_EQ(out[2], TEMP_FROM_INT(26));
+    CHECK_EQ(Sensor_ResolutionBits(&sensor), 4);
+}
+
+static void test_shift2_rounded_mean_every_4(void)
+{
+    /* 25.0625 x2, 25.125 x2 -> 25.09375 (half an LSB, exact in Q8.8) */
+    static const Temp_t script[] = {
+        TEMP_FROM_INT(25) + LSB, TEMP_FROM_INT(25) + LSB, TEMP_FROM_INT(25) + 2 * LSB, TEMP_FROM_INT(25) + 2 * LSB,
+        TEMP_FROM_INT(25), TEMP_FROM_INT(25), TEMP_FROM_INT(25), TEMP_FROM_INT(25) + 2,
+        -LSB, -LSB, -LSB, 0,
+    };
+    FakeSensor_t fake = { script, 12, 0, 0 };
+    Sensor_t sensor = SENSOR_ENTRY(&FakeOps, &fake, PERIOD_MS, TIMEOUT_MS, 2);
+    Temp_t out[12];
+
+    CHECK_EQ(RunScript(&sensor, &fake, out), 3);
+    CHECK_EQ(out[0], TEMP_FROM_INT(25) + LSB + LSB / 2);
+    CHECK_EQ(out[1], TEMP_FROM_INT(25) + 1);        /* 2/4 rounds up */
+    CHECK_EQ(out[2], -(3 * LSB) / 4);
+    CHECK_EQ(fake.reads, 12);
+
+    /* 12-bit + 4x: 5 fractional bits, enough for two displayed decimals */
+    CHECK_EQ(Sensor_ResolutionBits(&sensor), 5);
+}
+
+static void test_failed_read_drops_partial_sum(void)
+{
+    /* Two readings of 30 degC, a failed read, then four of 20 degC */
+    static const Temp_t script[] = {
+        TEMP_FROM_INT(30), TEMP_FROM_INT(30), STEP_READ_FAIL,
+        TEMP_FROM_INT(20), TEMP_FROM_INT(20), TEMP_FROM_INT(20), TEMP_FROM_INT(20),
+    };
+    FakeSensor_t fake = { script, 7, 0, 0 };
+    Sensor_t sensor = SENSOR_ENTRY(&FakeOps, &fake, PERIOD_MS, TIMEOUT_MS, 2);
+    Temp_t out[7];
+
+    CHECK_EQ(RunScript(&sensor, &fake, out), 1);
+    CHECK_EQ(out[0], TEMP_FROM_INT(20));
+    CHECK_EQ(sensor.valid, 1);
+    CHECK_EQ(sensor.accCount, 0);
+}
+
+static void test_timeout_drops_partial_sum(void)
+{
+    static const Temp_t script[] = {
+        TEMP_FROM_INT(30), TEMP_FROM_INT(30), TEMP_FROM_INT(30), STEP_NO_READY,
+        TEMP_FROM_INT(20), TEMP_FROM_INT(20), TEMP_FROM_INT(20), TEMP_FROM_INT(20),
+    };
+    FakeSensor_t fake = { script, 8, 0, 0 };
+    Sensor_t sensor = SENSOR_ENTRY(&FakeOps, &fake, PERIOD_MS, TIMEOUT_MS, 2);
+    Temp_t out[8];
+
+    CHECK_EQ(RunScript(&sensor, &fake, out), 1);
+    CHECK_EQ(out[0], TEMP_FROM_INT(20));
+    CHECK_EQ(fake.reads, 7);
+}
+
+static void test_shift_clamped(void)
+{
+    static const Temp_t script[] = { 0 };
+    FakeSensor_t fake = { script, 1, 0, 0 };
+    Sensor_t sensor = SENSOR_ENTRY(&FakeOps, &fake, PERIOD_MS, TIMEOUT_MS, 12);
+
+    Sensor_Init(&sensor, 0);
+    CHECK_EQ(sensor.oversampleShift, SENSOR_OVERSAMPLE_MAX_SHIFT);
+    CHECK_EQ(Sensor_ResolutionBits(&sensor), 4 + SENSOR_OVERSAMPLE_MAX_SHIFT / 2);
+}
+
+int main(void)
+{
+    int failed = 0;
+
+    RUN(test_no_oversampling_passes_through);
+    RUN(test_shift2_rounded_mean_every_4);
+    RUN(test_failed_read_drops_partial_sum);
+    RUN(test_timeout_drops_partial_sum);
+    RUN(test_shift_clamped);
+    return failed ? 1 : 0;
+}
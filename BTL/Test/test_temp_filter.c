@@ -0,0 +1,134 @@
+/**
+  ******************************************************************************
+  * @file    test_temp_filter.c
+  * @brief   Trace replay through TempFilter_* (median-of-3 + EMA)
+  * @details The trace is synthetic, shaped like a DS18B20 log at 12 bits:
+  *          a flat 25 degC with +-1 LSB noise, single-sample spikes
+  *          (85 degC power-on value, a bit error), a two-sample spike, then a
+  *          3 degC step. Assertions are on the filtered output only.
+  ******************************************************************************
+  */
+
+#include "test_common.h"
+#include "temp_filter.h"
+
+#define LSB             (TEMP_ONE / 16)     /* DS18B20 12-bit step in Q8.8 */
+#define BASE            TEMP_FROM_INT(25)
+#define STEP            TEMP_FROM_INT(28)
+#define TRACE_LEN       120
+#define STEP_AT         80
+#define PERIOD_MS       750
+
+static Temp_t trace[TRACE_LEN];
+
+static void BuildTrace(void)
+{
+    static const int8_t noise[8] = { 0, 1, 0, -1, 1, 0, -1, 0 };
+
+    for (uint16_t i = 0; i < TRACE_LEN; i++)
+    {
+        trace[i] = (Temp_t)(((i < STEP_AT) ? BASE : STEP) + noise[i % 8] * LSB);
+    }
+    trace[20] = TEMP_FROM_INT(85);          /* Power-on scratchpad */
+    trace[40] = (Temp_t)(BASE - 0x0800);    /* Bit 11 flipped: -8 degC */
+    trace[60] = TEMP_FROM_INT(40);          /* Two-sample burst */
+    trace[61] = TEMP_FROM_INT(40);
+}
+
+static void Replay(Temp_t *out)
+{
+    TempFilter_t filter;
+
+    TempFilter_Init(&filter);
+    for (uint16_t i = 0; i < TRACE_LEN; i++)
+    {
+        TempSample_t in = { trace[i], 1000U + i * PERIOD_MS };
+        TempSample_t y = TempFilter_Update(&filter, in);
+
+        CHECK_EQ(y.timestamp, in.timestamp);
+        out[i] = y.value;
+    }
+}
+
+static int16_t Abs16(int32_t v)
+{
+    return (int16_t)((v < 0) ? -v : v);
+}
+
+/* ========== Test Cases ========== */
+
+static void test_primes_on_first_sample(void)
+{
+    TempFilter_t filter;
+    TempSample_t in = { TEMP_FROM_INT(-10) - LSB, 0 };
+
+    TempFilter_Init(&filter);
+    CHECK_EQ(TempFilter_Update(&filter, in).value, in.value);
+    CHECK_EQ(TempFilter_Update(&filter, in).value, in.value);   /* Negative: no drift */
+}
+
+static void test_single_spikes_rejected(void)
+{
+    Temp_t out[TRACE_LEN];
+
+    BuildTrace();
+    Replay(out);
+    for (uint16_t i = 0; i < 55; i++)
+    {
+        CHECK(Abs16(out[i] - BASE) <= LSB);
+    }
+}
+
+static void test_double_spike_attenuated(void)
+{
+    Temp_t out[TRACE_LEN];
+    Temp_t peak = 0;
+
+    BuildTrace();
+    Replay(out);
+    for (uint16_t i = 55; i < STEP_AT; i++)
+    {
+        if (out[i] > peak)
+        {
+            peak = out[i];
+        }
+    }
+    /* Median passes it for two samples, the EMA keeps 1 - (3/4)^2 of it */
+    CHECK(peak > BASE + TEMP_FROM_INT(1));
+    CHECK(peak - BASE < (TEMP_FROM_INT(40) - BASE) / 2);
+    CHECK(Abs16(out[STEP_AT - 1] - BASE) <= 2 * LSB);           /* Recovered */
+}
+
+static void test_step_settles_without_overshoot(void)
+{
+    Temp_t out[TRACE_LEN];
+    uint16_t settled = TRACE_LEN;
+
+    BuildTrace();
+    Replay(out);
+    CHECK(out[STEP_AT] < BASE + LSB * 2);                       /* One sample median delay */
+    for (uint16_t i = STEP_AT; i < TRACE_LEN; i++)
+    {
+        CHECK(out[i] <= STEP + LSB);
+        if (settled == TRACE_LEN && Abs16(out[i] - STEP) <= LSB)
+        {
+            settled = i;
+        }
+    }
+    CHECK(settled - STEP_AT <= 20);                             /* 1/4 EMA, 48 LSB step */
+    for (uint16_t i = settled; i < TRACE_LEN; i++)
+    {
+        CHECK(Abs16(out[i] - STEP) <= LSB);
+    }
+}
+
+int main(void)
+{
+    int failed = 0;
+
+    RUN(test_primes_on_first_sample);
+    RUN(test_single_spikes_rejected);
+    RUN(test_double_spike_attenuated);
+    RUN(test_step_settles_without_overshoot);
+    return failed ? 1 : 0;
+}